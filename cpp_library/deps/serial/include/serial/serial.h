@@ -226,6 +226,12 @@ public:
   bool
   waitReadable ();
 
+  /*! Block until there is serial data to read or timeout number of
+   * milliseconds have elapsed. Same as waitReadable (), but does not use
+   * (or change) the port's timeout settings. */
+  bool
+  waitReadable (uint32_t timeout);
+
   /*! Block for a period of time corresponding to the transmission time of
    * count characters at present serial settings. This may be used in con-
    * junction with waitReadable to read larger blocks of data from the
@@ -108,6 +108,12 @@ Serial::waitReadable ()
   return pimpl_->waitReadable(timeout.read_timeout_constant);
 }
 
+bool
+Serial::waitReadable (uint32_t timeout)
+{
+  return pimpl_->waitReadable(timeout);
+}
+
 void
 Serial::waitByteTimes (size_t count)
 {
@@ -20,9 +20,15 @@
 #pragma once
 
 #include <arpirobot/arduino/iface/BaseArduinoInterface.hpp>
+#include <arpirobot/core/util/ByteView.hpp>
+#include <arpirobot/core/util/SampleHistory.hpp>
+#include <arpirobot/core/util/SeqLock.hpp>
+#include <arpirobot/core/util/Endian.hpp>
 
 #include <string>
 #include <vector>
+#include <chrono>
+#include <atomic>
 
 namespace arpirobot{
 
@@ -34,6 +40,8 @@ namespace arpirobot{
      */
     class ArduinoDevice{
     public:
+        // Number of readings kept in each device's history
+        const static size_t HISTORY_SIZE = 64;
 
         /**
          * @param createDevice If this is true the arduino this device is added to will be instructed to instantiate
@@ -52,22 +60,64 @@ namespace arpirobot{
     protected:
         static std::vector<uint8_t> stringToData(const std::string &str);
 
+        // Device's data from data passed to handleData (without the deviceId)
+        static ByteView payloadOf(ByteView data);
+
+        /**
+         * Add a reading from the data being handled to a history (called from handleData).
+         * Firmware that timestamps readings sends the arduino's time (micros(), uint32 little endian)
+         * after the reading's data. If the payload has this the sample's deviceTime is set.
+         * @param history History to add to
+         * @param value The reading
+         * @param payload The device's data (see payloadOf)
+         * @param readingSize Number of bytes of the payload used for the reading
+         */
+        template <typename T>
+        void recordSample(SampleHistory<T, HISTORY_SIZE> &history, const T &value, ByteView payload, size_t readingSize){
+            typename SampleHistory<T, HISTORY_SIZE>::Sample sample;
+            sample.value = value;
+            sample.hostTime = receiveTime;
+            if(payload.size() >= readingSize + 4){
+                sample.deviceTime = Endian::readLittle<uint32_t>(&payload[readingSize]);
+                sample.hasDeviceTime = true;
+            }
+            history.push(sample);
+        }
+
         void setArduino(BaseArduinoInterface *arduino);
         void setDeviceId(int deviceId);
 
+        /**
+         * Send data to this device's instance on the arduino. The first byte is the command type.
+         * The data is queued (see BaseArduinoInterface::sendFromDevice). If a command of the same type is still
+         * waiting to be sent it is replaced, so only the latest value (ex: a setpoint) is sent.
+         * @return true if queued, false if not (no arduino, device not created, or queue full)
+         */
         bool sendData(const std::vector<uint8_t> &data);
         bool sendData(const std::string &data);
 
         // Device specific
         virtual void applyDefaultState() = 0;
         virtual std::vector<uint8_t> getCreateData() = 0;
-        virtual void handleData(const std::vector<uint8_t> &data) = 0;
+        /**
+         * Handle data received from this device's instance on the arduino.
+         * NOTE: data does NOT end with the frame's two CRC bytes (they used to be included). It is exactly the
+         * device ID followed by the device's data (data.size() - 1 bytes, see payloadOf). The CRC has already
+         * been checked. Implementations must not strip two trailing bytes.
+         * The data may be part of an aggregated frame holding data for several devices, so it is only valid
+         * for the duration of the call.
+         * @param data deviceId, data...
+         */
+        virtual void handleData(ByteView data) = 0;
 
         bool createDevice;
         int deviceId;
 
         std::string deviceName;
 
+        // When the data passed to handleData was received. Set before handleData is called.
+        std::chrono::steady_clock::time_point receiveTime;
+
         // Not a shared_ptr because this is set and cleared by the managing ArduinoInterface
         // This should not keep an ArduinoInterface in scope. The interface keeps devices
         // in scope. When interface goes out of scope, devices can as well;
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <arpirobot/arduino/iface/BaseArduinoInterface.hpp>
+
+namespace arpirobot{
+
+    /**
+     * \class ArduinoAsyncUartInterface ArduinoAsyncUartInterface.hpp arpirobot/arduino/iface/ArduinoAsyncUartInterface.hpp
+     *
+     * Arduino interface implementation using UART to communicate with the arduino. Unlike ArduinoUartInterface,
+     * no thread waits for data from each arduino. Received data is handled as it arrives on one thread shared
+     * by every ArduinoAsyncUartInterface (see ArduinoReactor), so using several arduinos does not add threads.
+     *
+     * Writes do not wait either. Data is queued for each port and written as the port accepts it, so
+     * one arduino that is slow to accept data does not delay the others.
+     * The serial port is accessed directly (not through the IO provider).
+     */
+    class ArduinoAsyncUartInterface : public BaseArduinoInterface{
+    public:
+
+        /**
+         * @param port The UART port for the arduino (/dev/tty... or COM...)
+         * @param baud The baud rate for UART communication
+         */
+        ArduinoAsyncUartInterface(std::string port, int baud);
+
+        ~ArduinoAsyncUartInterface();
+
+        ArduinoAsyncUartInterface(const ArduinoAsyncUartInterface &other) = delete;
+
+        ArduinoAsyncUartInterface &operator=(const ArduinoAsyncUartInterface &other) = delete;
+
+    protected:
+        void open() override;
+        void close() override;
+        bool isOpen() override;
+        int available() override;
+        size_t readChunk(uint8_t *buf, size_t count, int timeoutMs) override;
+        void write(const uint8_t *data, size_t len) override;
+        std::string getDeviceName() override;
+
+        void startProcessing() override;
+        void stopProcessing() override;
+
+        // Messages from devices are written by the reactor thread
+        void requestSend() override;
+
+    private:
+        // Start reading into readBuffer (reactor thread only)
+        void startRead();
+
+        // Read completion handler (reactor thread)
+        void handleRead(const std::error_code &ec, size_t count);
+
+        // Start writing txPending (reactor thread only)
+        void startWrite();
+
+        // Write completion handler (reactor thread)
+        void handleWrite(const std::error_code &ec, size_t count);
+
+        std::string port;
+        int baud;
+
+        std::unique_ptr<asio::serial_port> serialPort;
+
+        // A read is always in progress while the port is open (one at a time, into readBuffer)
+        std::array<uint8_t, 512> readBuffer;
+
+        // Data being written (reactor thread only)
+        std::vector<uint8_t> txWriting;
+
+        // True while received data is given to processReceived (reactor thread only).
+        // Otherwise received data is kept in rxPending for readChunk.
+        bool processing = false;
+
+        // True while a sendQueued is posted to the reactor and has not started yet
+        std::atomic<bool> sendPosted {false};
+
+        // Guards the below. cv is notified when any of them change.
+        std::mutex lock;
+        std::condition_variable cv;
+        std::vector<uint8_t> rxPending;
+        bool reading = false;
+        bool failed = false;
+
+        // Data waiting to be written and whether a write is in progress (or posted)
+        std::vector<uint8_t> txPending;
+        bool writing = false;
+
+        // Shared reactor (nullptr when not open)
+        asio::io_service *io = nullptr;
+
+        // Number of posted sends that have not finished. close waits for them (they use this object).
+        int postedSends = 0;
+
+        // Most received data kept for readChunk (older data is dropped)
+        const static size_t MAX_PENDING;
+
+        // Most data waiting to be written (writes that would exceed this fail)
+        const static size_t MAX_TX_PENDING;
+    };
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+
+namespace arpirobot{
+
+    /**
+     * \class ArduinoReactor ArduinoReactor.hpp arpirobot/arduino/iface/ArduinoReactor.hpp
+     *
+     * Shared io_service for arduino interfaces that use asynchronous I/O (see ArduinoAsyncUartInterface).
+     * All completion handlers run on one thread, no matter how many interfaces use it. The thread is started
+     * when the first interface acquires the reactor and stopped when the last one releases it.
+     * THIS SHOULD NOT BE USED FROM USER CODE.
+     */
+    class ArduinoReactor{
+    public:
+        /**
+         * Start using the reactor (starting its thread if this is the first user)
+         * Each call must be matched by a call to ArduinoReactor::release
+         * @return The shared io_service
+         */
+        static asio::io_service &acquire();
+
+        /**
+         * Stop using the reactor. The thread is stopped (after running any pending handlers) if this was the last user.
+         * All of the user's operations must have completed first.
+         */
+        static void release();
+
+        /**
+         * Run a function on the reactor thread and wait for it to finish. If called from the reactor thread
+         * the function is run immediately. Exceptions thrown by the function are rethrown here.
+         * The reactor must have been acquired.
+         */
+        static void runAndWait(const std::function<void()> &func);
+
+    private:
+        static void run();
+
+        static asio::io_service io;
+        static std::unique_ptr<asio::io_service::work> wk;
+        static std::thread *reactorThread;
+        static std::mutex lock;
+        static int users;
+    };
+
+}
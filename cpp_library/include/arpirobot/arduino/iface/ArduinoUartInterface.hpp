@@ -53,9 +53,8 @@ namespace arpirobot{
         void close() override;
         bool isOpen() override;
         int available() override;
-        uint8_t readOne() override;
-        std::vector<uint8_t> readAll() override;
-        void write(const uint8_t &b) override;
+        size_t readChunk(uint8_t *buf, size_t count, int timeoutMs) override;
+        void write(const uint8_t *data, size_t len) override;
         std::string getDeviceName() override;
     
     private:
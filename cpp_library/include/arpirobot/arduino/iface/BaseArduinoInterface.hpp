@@ -20,17 +20,45 @@
 #pragma once
 
 #include <thread>
+#include <array>
 #include <vector>
 #include <string>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <unordered_map>
 
+#include <arpirobot/core/util/ByteView.hpp>
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
+
 namespace arpirobot{
 
     // Forward declare
     class ArduinoDevice;
 
+    /**
+     * Counters for the commands sent to devices by an arduino interface
+     */
+    struct ArduinoSendStats{
+        /// Commands currently waiting to be sent
+        size_t queuedCommands = 0;
+
+        /// Most commands that have been waiting to be sent at once
+        size_t peakQueuedCommands = 0;
+
+        /// Total commands written to the arduino
+        uint64_t sentCommands = 0;
+
+        /// Total commands replaced by a newer command of the same type for the same device before being sent
+        uint64_t coalescedCommands = 0;
+
+        /// Total commands dropped (queue full, write failed or the arduino was reconfigured before they were sent)
+        uint64_t droppedCommands = 0;
+    };
+
     /**
      * \class BaseArduinoInterface BaseArduinoInterface.hpp arpirobot/arduino/iface/BaseArduinoInterface.hpp
      * 
@@ -74,39 +102,115 @@ namespace arpirobot{
          */
         bool isReady();
 
+        /**
+         * Returns true if the arduino agreed (during BaseArduinoInterface::begin) to send the data of all devices
+         * in one aggregated frame per sample period instead of one frame per device. Older firmware does not
+         * support this. Frames of either kind are handled either way.
+         */
+        bool isAggregating();
+
         /**
          * Send a message from a specific device.
          * THIS SHOULD NOT BE USED FROM USER CODE.
-         * Sends a message to the associated device instance on the arduino.
+         * Queues a message for the associated device instance on the arduino. The first byte of the data is the
+         * command type. A queued message with the same device and command type that has not been sent yet is
+         * replaced (only the latest one is sent). Messages are sent once the arduino is ready.
          * @param deviceId The sending/receiving device's ID
          * @param data The data to send
+         * @return true if queued, false if dropped because the queue is full
+         */
+        bool sendFromDevice(uint8_t deviceId, ByteView data);
+
+        /**
+         * Get a copy of the counters for messages sent from devices
+         */
+        ArduinoSendStats getSendStats();
+
+        /**
+         * @return Histogram of the time from queueing a message from a device until it is given to the interface
+         *         to write (ns)
          */
-        void sendFromDevice(uint8_t deviceId, std::vector<uint8_t> data);
+        const LatencyHistogram &getSendLatency() const;
 
     protected:
         
         // Communication functions
 
+        // Body of the default processing thread. Reads and handles frames until arduinoReady is cleared.
         void run();
 
+        // Body of the default send thread. Writes queued messages when requested until arduinoReady is cleared.
+        void sendLoop();
+
+        /**
+         * Start handling received frames (called by begin once the arduino is configured).
+         * By default a processing thread is started that reads from the interface using readChunk, along with a
+         * send thread that writes messages from devices (see requestSend).
+         * Interfaces that are notified of received data (instead of waiting for it) override this and
+         * startProcessing / stopProcessing and give the data to processReceived instead. They also override
+         * requestSend, as no send thread is started.
+         */
+        virtual void startProcessing();
+
+        /**
+         * Stop handling received frames. Called by begin before configuring the arduino. Implementations
+         * call this in their destructor (processing may use the implementation's functions).
+         * Once this returns, processReceived must not be called again until startProcessing is called.
+         */
+        virtual void stopProcessing();
+
+        /**
+         * Parse and handle received data. Used by interfaces that override startProcessing.
+         * Bytes left over from the last readData are handled first.
+         * All calls must be made from one thread at a time.
+         * @param data The received bytes
+         * @param len Number of received bytes
+         * @return false if processing has stopped (the arduino reset or communication failed). Reconfiguration
+         *         has been scheduled and no more data should be given to this function until startProcessing
+         *         is called again.
+         */
+        bool processReceived(const uint8_t *data, size_t len);
+
+        /**
+         * Called when messages from devices are queued. Never writes on the calling thread.
+         * By default the send thread started by startProcessing is woken to call sendQueued.
+         * Interfaces that override startProcessing override this and call sendQueued on their own I/O thread.
+         */
+        virtual void requestSend();
+
+        /**
+         * Write all queued messages from devices (in one write). Nothing is written until the arduino is ready.
+         * Never waits for another thread that is writing (that thread writes the messages instead).
+         */
+        void sendQueued();
+
+        /**
+         * Log that communication with the arduino failed while processing and schedule reconfiguration
+         * @param details Description of the error (logged as a debug message)
+         */
+        void lostCommunication(const std::string &details);
+
         uint16_t calcCCittFalse(const std::vector<uint8_t> &data, size_t len);
 
         /**
          * Writes a message to the arduino using proper escape sequences
+         * The whole frame is assembled in txBuffer and written with one call to write.
+         * Safe to call from multiple threads.
          * This funcion will throw exceptions from lower level I/O functions
          */
-        void writeData(const std::vector<uint8_t> &data);
+        void writeData(ByteView data);
 
         /**
-         * This method blocks until at least one byte is available. One byte is then read
-         * and stored in the workingBuffer. Escape, start, and end sequences are handled
-         * appropriately.
-         * When a full dataset has been read into the workingBuffer it is moved into the read_dataset.
+         * Parses received bytes into the workingBuffer. Escape, start, and end sequences are handled
+         * appropriately. Bytes are read from the interface in chunks (as many as are available) into rxBuffer
+         * and parsed until a full dataset has been read. Any remaining bytes are kept for the next call.
+         * When a full dataset has been read into the workingBuffer it is moved into the readDataset.
          * Then, this method return true.
-         * Otherwise it returns false
+         * Otherwise (no complete dataset within the timeout) it returns false
          * This function will throw exceptions from lower level I/O functions
+         * @param timeoutMs Maximum time to wait for data if no received bytes are left to parse
          */
-        bool readData();
+        bool readData(int timeoutMs);
 
         /**
          * Using the complete dataset in read_dataset, calculates the CRC and reads the CRC
@@ -114,6 +218,12 @@ namespace arpirobot{
          */
         bool checkData();
 
+        // The last complete dataset (including CRC). Valid after readData returns true.
+        std::vector<uint8_t> readDataset;
+
+        // When the last byte of readDataset was read from the interface
+        std::chrono::steady_clock::time_point readDatasetTime;
+
         // This function will throw exceptions from lower level I/O functoins
         std::vector<uint8_t> waitForMessage(const std::vector<uint8_t> &prefix, int timeoutMs);
 
@@ -123,35 +233,117 @@ namespace arpirobot{
         virtual void close() = 0;
         virtual bool isOpen() = 0;
         virtual int available() = 0;
-        virtual uint8_t readOne() = 0;
-        virtual std::vector<uint8_t> readAll() = 0;
-        virtual void write(const uint8_t &b) = 0;
+        // Wait up to timeoutMs for data, then read up to count bytes that are available. Returns bytes read (0 on timeout).
+        virtual size_t readChunk(uint8_t *buf, size_t count, int timeoutMs) = 0;
+        // Write a complete frame
+        virtual void write(const uint8_t *data, size_t len) = 0;
         virtual std::string getDeviceName() = 0;
 
     private:
 
+        // Parse one received byte. Returns true if it completed a frame (moved into readDataset).
+        bool parseByte(uint8_t b);
+
+        // Handle the frame in readDataset. Returns false if the arduino reset (reconfiguration is scheduled).
+        bool handleFrame();
+
+        // Writes a frame containing header followed by data (without copying either into a single message first)
+        void writeFrame(ByteView header, ByteView data);
+
+        // Adds a frame to the end of txBuffer
+        void appendFrame(ByteView header, ByteView data);
+
+        // Write all queued messages from devices (writeLock must be held)
+        void writeQueued();
+
+        // Drop messages that have not been sent yet
+        void dropQueued();
+
+        // Adds data to the end of txBuffer with escape sequences
+        void appendEscaped(ByteView data);
+
+        // Give data (deviceId, data...) to the device it is for
+        void dispatch(ByteView data);
+
+        // Give each device's data in an aggregated frame (without CRC) to the device
+        void dispatchAggregate(ByteView frame);
+
+        // Ask the arduino to send aggregated frames. Returns true if it agreed.
+        bool negotiateAggregate();
+
         static bool msgStartsWith(const std::vector<uint8_t> &msg, const std::vector<uint8_t> &prefix);
         static bool msgEquals(const std::vector<uint8_t> &msg1, const std::vector<uint8_t> &msg2);
 
+        // Received bytes not yet parsed are rxBuffer[rxPos, rxLen)
+        std::array<uint8_t, 512> rxBuffer;
+        size_t rxPos = 0;
+        size_t rxLen = 0;
+        std::chrono::steady_clock::time_point rxTime;
+
         std::vector<uint8_t> workingBuffer;
-        std::vector<uint8_t> readDataset;
+
+        // Frame being written (reused between writes). Guarded by writeLock.
+        std::vector<uint8_t> txBuffer;
+        std::mutex writeLock;
+
+        // A message from a device waiting to be sent
+        struct QueuedMessage{
+            uint8_t deviceId;
+            std::vector<uint8_t> data;
+            std::chrono::steady_clock::time_point queueTime;
+        };
+
+        // Messages waiting to be sent and send counters. Guarded by sendLock.
+        std::vector<QueuedMessage> sendQueue;
+        ArduinoSendStats sendStats;
+        std::mutex sendLock;
+
+        // Set when messages must be sent. Cleared by the thread that holds writeLock before it sends them.
+        std::atomic<bool> sendPending {false};
+
+        // Messages being written by sendQueued. Guarded by writeLock.
+        std::vector<QueuedMessage> sending;
+        LatencyHistogram sendLatency;
         bool parseStarted = false;
         bool parseEscaped = false;
         std::thread *processThread = nullptr;
+
+        // Wakes the default send thread. sendRequested is guarded by sendWakeLock.
+        std::thread *sendThread = nullptr;
+        std::mutex sendWakeLock;
+        std::condition_variable sendWake;
+        bool sendRequested = false;
         std::vector<std::shared_ptr<ArduinoDevice>> devices;
+
+        // Devices indexed by device ID (nullptr if no device has the ID). Built by begin before processing starts.
+        std::array<ArduinoDevice*, 256> devicesById;
         bool initialized = false;
-        bool arduinoReady = false;
+        std::atomic<bool> arduinoReady {false};
+        std::atomic<bool> aggregating {false};
 
         const static uint8_t START_BYTE;
         const static uint8_t END_BYTE;
         const static uint8_t ESCAPE_BYTE;
 
+        // First byte of an aggregated frame (in place of a device ID, so no device can use this ID)
+        const static uint8_t AGGREGATE_ID;
+
+        // How long the processing thread waits for data before checking if it should stop
+        const static int RUN_READ_TIMEOUT_MS;
+
+        // Most messages from devices waiting to be sent (with different devices or command types)
+        const static size_t MAX_QUEUED_MESSAGES;
+
+        // How long to wait for the arduino to accept aggregated frames (firmware without support does not reply)
+        const static int AGGREGATE_REPLY_TIMEOUT_MS;
+
         const static std::vector<uint8_t> MSG_START;
         const static std::vector<uint8_t> MSG_ADD;
         const static std::vector<uint8_t> MSG_ADDSUCCESS;
 
         const static std::vector<uint8_t> CMD_RESET;
         const static std::vector<uint8_t> CMD_END;
+        const static std::vector<uint8_t> CMD_AGGREGATE;
 
         friend class ArduinoDevice;
     };
@@ -30,6 +30,16 @@ namespace arpirobot{
      */
     class IRReflectorModule : public ArduinoDevice{
     public:
+        /**
+         * Digital and analog values received from the arduino
+         */
+        struct Reading{
+            bool digitalValue;
+            int analogValue;
+        };
+
+        typedef SampleHistory<Reading, HISTORY_SIZE> History;
+
         /**
          * @param digitalPin The digital output pin for this sensor
          * @param createDevice Leave this true unless the device is hard-coded in arduino firmware
@@ -72,15 +82,27 @@ namespace arpirobot{
          */
         int getAnalogValue();
 
+        /**
+         * Get all values from the most recent data received from the arduino at once. The values are always
+         * from the same data (unlike calling several getters). Can be used from any thread.
+         */
+        Reading snapshot() const;
+
+        /**
+         * Get recent readings with the time each was received (and the arduino's time if the firmware sends it).
+         * Can be used from any thread.
+         */
+        const History &getHistory() const;
+
     protected:
         void applyDefaultState() override;
         std::vector<uint8_t> getCreateData() override;
-        void handleData(const std::vector<uint8_t> &data) override;
+        void handleData(ByteView data) override;
     
     private:
         std::string digitalPin;
         std::string analogPin;
-        bool digitalValue = false;
-        int analogValue = 0;
+        SeqLock<Reading> state;
+        History history;
     };
 }
\ No newline at end of file
@@ -33,6 +33,16 @@ namespace arpirobot{
      */
     class Mpu6050Imu : public ArduinoDevice{
     public:
+        /**
+         * Gyro and accelerometer values received from the arduino
+         */
+        struct Reading{
+            // Same as the getters (gyro offsets applied)
+            double gyroX, gyroY, gyroZ;
+            double accelX, accelY, accelZ;
+        };
+
+        typedef SampleHistory<Reading, HISTORY_SIZE> History;
 
         /**
          * @param createDevice Leave this true unless the device is hard-coded in arduino firmware
@@ -40,6 +50,8 @@ namespace arpirobot{
          */
         Mpu6050Imu(bool createDevice = true, int deviceId = -1);
 
+        ~Mpu6050Imu();
+
         /**
          * Calibrate the IMU. Should reduce gyro drift and accelerometer error
          * IMU MUST BE STATIONARY DURING CALIBRATION. 
@@ -103,14 +115,38 @@ namespace arpirobot{
          */
         void setGyroZ(double newGyroZ);
 
+        /**
+         * Get all values from the most recent data received from the arduino at once. The values are always
+         * from the same data (unlike calling several getters). Can be used from any thread.
+         */
+        Reading snapshot() const;
+
+        /**
+         * Get recent readings with the time each was received (and the arduino's time if the firmware sends it).
+         * Can be used from any thread.
+         */
+        const History &getHistory() const;
+
+        /**
+         * Add this IMU as a telemetry source (fields: gyroX, gyroY, gyroZ, accelX, accelY, accelZ)
+         * The source is removed when this object is destroyed (or if this is called again).
+         * @return The ID of the source (-1 if the source could not be added)
+         */
+        int addTelemetrySource();
+
     protected:
         void applyDefaultState() override;
         std::vector<uint8_t> getCreateData() override;
-        void handleData(const std::vector<uint8_t> &data) override;
+        void handleData(ByteView data) override;
     
     private:
-        double gyroX = 0, gyroY = 0, gyroZ = 0, accelX = 0, accelY = 0, accelZ = 0;
-        double gyroXOffset = 0, gyroYOffset = 0, gyroZOffset = 0;
+        // Latest values received (without gyro offsets)
+        SeqLock<Reading> state;
+        std::atomic<double> gyroXOffset {0}, gyroYOffset {0}, gyroZOffset {0};
+        History history;
+
+        // Telemetry source sampling this object (-1 if none)
+        int telemetrySourceId = -1;
     };
 
 }
\ No newline at end of file
@@ -30,6 +30,17 @@ namespace arpirobot{
      */
     class NxpAdafruit9Dof : public ArduinoDevice{
     public:
+        /**
+         * Gyro and accelerometer values received from the arduino
+         */
+        struct Reading{
+            // Same as the getters (gyro offsets applied)
+            double gyroX, gyroY, gyroZ;
+            double accelX, accelY, accelZ;
+        };
+
+        typedef SampleHistory<Reading, HISTORY_SIZE> History;
+
         /**
          * @param createDevice Leave this true unless the device is hard-coded in arduino firmware
          * @param deviceId Set this to the hard-coded deviceId if createDevice is false
@@ -99,14 +110,28 @@ namespace arpirobot{
          */
         void setGyroZ(double newGyroZ);
 
+        /**
+         * Get all values from the most recent data received from the arduino at once. The values are always
+         * from the same data (unlike calling several getters). Can be used from any thread.
+         */
+        Reading snapshot() const;
+
+        /**
+         * Get recent readings with the time each was received (and the arduino's time if the firmware sends it).
+         * Can be used from any thread.
+         */
+        const History &getHistory() const;
+
     protected:
         void applyDefaultState() override;
         std::vector<uint8_t> getCreateData() override;
-        void handleData(const std::vector<uint8_t> &data) override;
+        void handleData(ByteView data) override;
     
     private:
-        double gyroX = 0, gyroY = 0, gyroZ = 0, accelX = 0, accelY = 0, accelZ = 0;
-        double gyroXOffset = 0, gyroYOffset = 0, gyroZOffset = 0;
+        // Latest values received (without gyro offsets)
+        SeqLock<Reading> state;
+        std::atomic<double> gyroXOffset {0}, gyroYOffset {0}, gyroZOffset {0};
+        History history;
     };
 
 }
@@ -30,6 +30,15 @@ namespace arpirobot{
      */
     class QuadEncoder : public ArduinoDevice{
     public:
+        /**
+         * Position and velocity received from the arduino
+         */
+        struct Reading{
+            int32_t position;   // Ticks (same as getPosition)
+            float velocity;     // Ticks / sec
+        };
+
+        typedef SampleHistory<Reading, HISTORY_SIZE> History;
 
         /**
          * @param pinA The digital pin number channel A is connected to
@@ -67,6 +76,8 @@ namespace arpirobot{
          */
         QuadEncoder(std::string pinA, std::string pinB, bool useInternalPullup, bool createDevice = true, int deviceId = -1);
 
+        ~QuadEncoder();
+
         /**
          * Get the position (tick count) for this encoder
          * @return The position in ticks
@@ -84,19 +95,42 @@ namespace arpirobot{
          * @return The speed in ticks / sec
          */
         float getVelocity();
+
+        /**
+         * Get all values from the most recent data received from the arduino at once. The values are always
+         * from the same data (unlike calling several getters). Can be used from any thread.
+         */
+        Reading snapshot() const;
+
+        /**
+         * Get recent readings with the time each was received (and the arduino's time if the firmware sends it).
+         * Can be used from any thread.
+         */
+        const History &getHistory() const;
+
+        /**
+         * Add this encoder as a telemetry source (fields: position, velocity)
+         * The source is removed when this object is destroyed (or if this is called again).
+         * @return The ID of the source (-1 if the source could not be added)
+         */
+        int addTelemetrySource();
     
     protected:
         void applyDefaultState() override;
         std::vector<uint8_t> getCreateData() override;
-        void handleData(const std::vector<uint8_t> &data) override;
+        void handleData(ByteView data) override;
     
     private:
         static const uint8_t numSamples = 5;
 
         std::string pinA, pinB;
         uint8_t useInternalPullup;
-        int32_t count = 0;
-        int32_t countOffset = 0;
-        float velocity = 0;
+        // Latest values received (position without countOffset)
+        SeqLock<Reading> state;
+        std::atomic<int32_t> countOffset {0};
+        History history;
+
+        // Telemetry source sampling this object (-1 if none)
+        int telemetrySourceId = -1;
     };
 }
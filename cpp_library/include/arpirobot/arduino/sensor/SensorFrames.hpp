@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <arpirobot/core/util/FrameLayout.hpp>
+#include <cstdint>
+
+namespace arpirobot{
+
+    // Layouts of data sent by the arduino that several sensors share.
+    // THESE SHOULD NOT BE USED FROM USER CODE.
+    namespace internal{
+
+        /**
+         * Data sent by IMUs: gyro x, y, z then accel x, y, z (floats, little endian)
+         */
+        struct ImuFrame{
+            float gyroX, gyroY, gyroZ;
+            float accelX, accelY, accelZ;
+        };
+
+        typedef FrameLayout<ByteOrder::Little, ImuFrame,
+            ARPIROBOT_FRAME_FIELD(ImuFrame, gyroX),
+            ARPIROBOT_FRAME_FIELD(ImuFrame, gyroY),
+            ARPIROBOT_FRAME_FIELD(ImuFrame, gyroZ),
+            ARPIROBOT_FRAME_FIELD(ImuFrame, accelX),
+            ARPIROBOT_FRAME_FIELD(ImuFrame, accelY),
+            ARPIROBOT_FRAME_FIELD(ImuFrame, accelZ)> ImuLayout;
+
+        /**
+         * Data sent by encoders: 32-bit count (int) and 32-bit velocity (float), little endian
+         */
+        struct EncoderFrame{
+            int32_t count;
+            float velocity;
+        };
+
+        typedef FrameLayout<ByteOrder::Little, EncoderFrame,
+            ARPIROBOT_FRAME_FIELD(EncoderFrame, count),
+            ARPIROBOT_FRAME_FIELD(EncoderFrame, velocity)> EncoderLayout;
+    }
+
+}
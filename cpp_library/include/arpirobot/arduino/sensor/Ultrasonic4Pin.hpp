@@ -30,6 +30,15 @@ namespace arpirobot{
      */
     class Ultrasonic4Pin : public ArduinoDevice{
     public:
+        /**
+         * Distance received from the arduino
+         */
+        struct Reading{
+            int distance;
+        };
+
+        typedef SampleHistory<Reading, HISTORY_SIZE> History;
+
         /**
          * @param triggerPin Digital pin number for the trigger pin
          * @param echoPin Digital pin number for the echo pin
@@ -67,16 +76,29 @@ namespace arpirobot{
          * @return The distance in cm
          */
         int getDistance();
+
+        /**
+         * Get all values from the most recent data received from the arduino at once. The values are always
+         * from the same data (unlike calling several getters). Can be used from any thread.
+         */
+        Reading snapshot() const;
+
+        /**
+         * Get recent readings with the time each was received (and the arduino's time if the firmware sends it).
+         * Can be used from any thread.
+         */
+        const History &getHistory() const;
     
     protected:
         void applyDefaultState() override;
         std::vector<uint8_t> getCreateData() override;
-        void handleData(const std::vector<uint8_t> &data) override;
+        void handleData(ByteView data) override;
     
     private:
         std::string triggerPin;
         std::string echoPin;
-        int distance = 0;
+        SeqLock<Reading> state;
+        History history;
     };
     
 }
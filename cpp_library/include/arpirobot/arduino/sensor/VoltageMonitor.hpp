@@ -31,6 +31,14 @@ namespace arpirobot{
      */
     class VoltageMonitor : public ArduinoDevice, public MainVmon{
     public:
+        /**
+         * Voltage received from the arduino
+         */
+        struct Reading{
+            double voltage;
+        };
+
+        typedef SampleHistory<Reading, HISTORY_SIZE> History;
 
         /**
          * @param pin The analog input pin this voltage monitor is connected to (can be prefixed with letter A)
@@ -57,18 +65,31 @@ namespace arpirobot{
          * @return The voltage in volts
          */
         double getVoltage();
+
+        /**
+         * Get all values from the most recent data received from the arduino at once. The values are always
+         * from the same data (unlike calling several getters). Can be used from any thread.
+         */
+        Reading snapshot() const;
+
+        /**
+         * Get recent readings with the time each was received (and the arduino's time if the firmware sends it).
+         * Can be used from any thread.
+         */
+        const History &getHistory() const;
     
     protected:
         void applyDefaultState() override;
         std::vector<uint8_t> getCreateData() override;
-        void handleData(const std::vector<uint8_t> &data) override;
+        void handleData(ByteView data) override;
     
     private:
         std::string pin;
         double vboard;
         int r1;
         int r2;
-        double voltage = 0;
+        SeqLock<Reading> state;
+        History history;
     };
 
 }
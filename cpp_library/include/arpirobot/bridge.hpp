@@ -173,6 +173,26 @@ BRIDGE_FUNC void RobotProfile_setIoProvider(const char *ioProvider);
 
 BRIDGE_FUNC char *RobotProfile_getIoProvider();
 
+BRIDGE_FUNC void RobotProfile_setNetworkBindAddress(const char *networkBindAddress);
+
+BRIDGE_FUNC char *RobotProfile_getNetworkBindAddress();
+
+BRIDGE_FUNC void RobotProfile_setControllerPort(int controllerPort);
+
+BRIDGE_FUNC int RobotProfile_getControllerPort();
+
+BRIDGE_FUNC void RobotProfile_setCommandPort(int commandPort);
+
+BRIDGE_FUNC int RobotProfile_getCommandPort();
+
+BRIDGE_FUNC void RobotProfile_setNetTablePort(int netTablePort);
+
+BRIDGE_FUNC int RobotProfile_getNetTablePort();
+
+BRIDGE_FUNC void RobotProfile_setLogPort(int logPort);
+
+BRIDGE_FUNC int RobotProfile_getLogPort();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// MainVMon Bridge
 ////////////////////////////////////////////////////////////////////////////////
@@ -213,6 +233,14 @@ BRIDGE_FUNC void Logger_logErrorFrom(const char *source, const char *message);
 
 BRIDGE_FUNC void Logger_logNewline();
 
+BRIDGE_FUNC void Logger_setLevel(int level);
+
+BRIDGE_FUNC int Logger_getLevel();
+
+BRIDGE_FUNC void Logger_setSourceLevel(const char *source, int level);
+
+BRIDGE_FUNC void Logger_clearSourceLevel(const char *source);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// BaseDevice bridge
@@ -23,23 +23,31 @@
 #include <cstddef>
 #include <vector>
 
+#include <arpirobot/core/util/ByteView.hpp>
+
 namespace arpirobot{
 
+    /**
+     * \class Conversions conversions.hpp arpirobot/core/conversions.hpp
+     * 
+     * Conversions between numbers and bytes in messages.
+     * Kept for compatibility. New code should use Endian (no allocations) or FrameLayout.
+     */
     class Conversions{
     public:
         static void checkBigEndian();
     
         static std::vector<uint8_t> convertInt32ToData(int32_t input, bool littleEndian);
 
-        static int32_t convertDataToInt32(const std::vector<uint8_t> &data, size_t offset, bool littleEndian);
+        static int32_t convertDataToInt32(ByteView data, size_t offset, bool littleEndian);
 
         static std::vector<uint8_t> convertInt16ToData(int16_t input, bool littleEndian);
 
-        static int16_t convertDataToInt16(const std::vector<uint8_t> &data, size_t offset, bool littleEndian);
+        static int16_t convertDataToInt16(ByteView data, size_t offset, bool littleEndian);
 
         static std::vector<uint8_t> convertFloatToData(float input, bool littleEndian);
 
-        static float convertDataToFloat(const std::vector<uint8_t> &data, size_t offset, bool littleEndian);
+        static float convertDataToFloat(ByteView data, size_t offset, bool littleEndian);
 
         static bool isBigEndian;
     };
@@ -32,7 +32,7 @@ namespace arpirobot{
     class MotorController : public BaseDevice{
     public:
 
-        virtual ~MotorController() = default;
+        virtual ~MotorController();
 
         /**
          * Check if the motor direction is inverted (positive and negative speed switched)
@@ -64,6 +64,13 @@ namespace arpirobot{
          */
         double getSpeed();
 
+        /**
+         * Add this motor controller's output as a telemetry source (fields: speed)
+         * The source is removed when this object is destroyed (or if this is called again).
+         * @return The ID of the source (-1 if the source could not be added)
+         */
+        int addTelemetrySource();
+
         /**
          * Set the current speed of the motor (no effect if motor is disabled)
          * @param speed The motor's speed (between -1.0 and 1.0)
@@ -88,6 +95,10 @@ namespace arpirobot{
         bool enabled = false;
         bool brakeMode = false;
         int8_t speedFactor = 1; // 1 or -1
+        uint64_t lastTraceFrame = 0; // See LatencyTracer
+
+        // Telemetry source sampling this object (-1 if none)
+        int telemetrySourceId = -1;
     };
 
 }
\ No newline at end of file
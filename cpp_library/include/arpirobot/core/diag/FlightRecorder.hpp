@@ -0,0 +1,154 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace arpirobot{
+
+    /**
+     * Header at the start of a flight recorder file. Followed by slotCount records.
+     * All values are in the robot's native byte order.
+     */
+    struct FlightRecorderHeader{
+        char magic[8];          // "ARPIFREC"
+        uint32_t version;       // 1
+        uint32_t recordSize;    // sizeof(FlightRecord)
+        uint64_t slotCount;
+        int64_t startTimeUs;    // Wall clock (us since unix epoch) when recording started
+        uint8_t reserved[32];
+    };
+
+    /**
+     * One fixed size record in a flight recorder file
+     */
+    struct FlightRecord{
+        // 0 while the record is being written (or if never written). Otherwise one more than the
+        // number of records written before this one. Written last so a record with a non zero
+        // sequence number is always complete, even if the program crashed.
+        uint64_t seq;
+
+        // Robot steady clock (us) relative to the start of the recording
+        uint64_t timeUs;
+
+        uint8_t type;           // FlightRecorder::RecordType
+        uint8_t length;         // Bytes of data used
+        uint16_t sub;           // Meaning depends on type (see RecordType)
+        uint32_t reserved;
+
+        uint8_t data[104];
+    };
+
+    /**
+     * \class FlightRecorder FlightRecorder.hpp arpirobot/core/diag/FlightRecorder.hpp
+     *
+     * Continuously records compact binary records of robot activity to a preallocated, memory mapped
+     * ring file (RobotProfile::flightRecorderFile). Records are written into the mapping directly, so they
+     * are kept by the OS even if the robot program crashes. The previous recording is kept as the
+     * same file name with ".1" appended. Use the flight-recorder-decode tool to convert a recording to text or CSV.
+     *
+     * Recording never allocates or locks. Each writer claims a slot with one atomic increment. Data
+     * longer than a record is truncated. Only supported on Linux.
+     */
+    class FlightRecorder{
+    public:
+        /**
+         * Type of a record
+         */
+        enum class RecordType : uint8_t{
+            Log = 1,            // Log line (text)
+            State = 2,          // Robot enabled (sub = 1) or disabled (sub = 0)
+            NetTable = 3,       // Net table change. key,255,value. sub = 1 if set by the DS.
+            Controller = 4,     // Controller packet (as received, without extended header). sub = controller number.
+            Motor = 5           // Motor speed set. speed (f32) followed by the device name.
+        };
+
+        /**
+         * Start recording to RobotProfile::flightRecorderFile (nothing is recorded if empty)
+         * @return true if recording
+         */
+        static bool start();
+
+        /**
+         * Stop recording and flush the recording to disk
+         */
+        static void stop();
+
+        /**
+         * @return true if recording
+         */
+        static bool isEnabled(){
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Record a log line (as printed)
+         */
+        static void recordLog(const std::string &line);
+
+        /**
+         * Record the robot being enabled or disabled
+         */
+        static void recordState(bool robotEnabled);
+
+        /**
+         * Record a net table change
+         * @param fromDs true if the change was made by the drive station
+         */
+        static void recordNetTable(const std::string &key, const std::string &value, bool fromDs);
+
+        /**
+         * Record a controller packet
+         */
+        static void recordController(int controller, const uint8_t *packet, size_t length);
+
+        /**
+         * Record a motor's speed being set
+         */
+        static void recordMotor(const std::string &device, double speed);
+
+        /**
+         * Write a record
+         * @param type The type of record
+         * @param sub Type specific value
+         * @param data1 First part of the data
+         * @param len1 Length of data1
+         * @param data2 Second part of the data (appended to data1, may be nullptr)
+         * @param len2 Length of data2
+         */
+        static void record(RecordType type, uint16_t sub, const void *data1, size_t len1,
+            const void *data2 = nullptr, size_t len2 = 0);
+
+        static const char MAGIC[8];
+        static const uint32_t VERSION = 1;
+
+    private:
+        static std::atomic<bool> enabled;
+        static std::atomic<uint64_t> nextSeq;
+        static FlightRecord *records;
+        static uint64_t slotCount;
+        static size_t mappedSize;
+        static void *mapping;
+        static int64_t startTimeNs;
+    };
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+
+namespace arpirobot{
+
+    /**
+     * \class HandlerStats HandlerStats.hpp arpirobot/core/diag/HandlerStats.hpp
+     * 
+     * Counters for a function that handles incoming data (calls, items handled, CPU time, 
+     * and wall time per call). Safe to read from any thread while being updated.
+     */
+    class HandlerStats{
+    public:
+        /**
+         * Record one call to the handler
+         * @param wallNs Time the call took (ns)
+         * @param cpuNs CPU time used by the calling thread during the call (ns)
+         * @param items Number of items (packets, commands, etc) handled by the call
+         */
+        void record(uint64_t wallNs, uint64_t cpuNs, uint64_t items);
+
+        /**
+         * @return Number of recorded calls
+         */
+        uint64_t getCalls() const;
+
+        /**
+         * @return Total number of items handled
+         */
+        uint64_t getItems() const;
+
+        /**
+         * @return Total CPU time used by the handler (ns). Always 0 on platforms without 
+         *         per thread CPU clocks.
+         */
+        uint64_t getCpuNs() const;
+
+        /**
+         * @return Histogram of wall time per call (ns)
+         */
+        const LatencyHistogram &getLatency() const;
+
+        /**
+         * Clear all counters
+         */
+        void reset();
+
+        /**
+         * @return CPU time used by the calling thread (ns), or 0 if not supported
+         */
+        static uint64_t threadCpuNs();
+
+    private:
+        std::atomic<uint64_t> calls {0};
+        std::atomic<uint64_t> items {0};
+        std::atomic<uint64_t> cpuNs {0};
+        LatencyHistogram latency;
+    };
+
+    /**
+     * \class HandlerTimer HandlerStats.hpp arpirobot/core/diag/HandlerStats.hpp
+     * 
+     * Records the duration of the enclosing scope to a HandlerStats object when destroyed.
+     * Does nothing (no clocks are read) unless RobotProfile::handlerStats is true.
+     */
+    class HandlerTimer{
+    public:
+        /**
+         * @param stats Where to record the call
+         * @param items Number of items handled (can be changed with setItems before the scope ends)
+         */
+        HandlerTimer(HandlerStats &stats, uint64_t items = 1);
+
+        ~HandlerTimer();
+
+        HandlerTimer(const HandlerTimer &other) = delete;
+        HandlerTimer &operator=(const HandlerTimer &other) = delete;
+
+        void setItems(uint64_t items);
+
+    private:
+        HandlerStats &stats;
+        bool active;
+        uint64_t items;
+        std::chrono::steady_clock::time_point startTime;
+        uint64_t startCpu;
+    };
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace arpirobot{
+
+    /**
+     * \class LatencyHistogram LatencyHistogram.hpp arpirobot/core/diag/LatencyHistogram.hpp
+     * 
+     * Fixed size histogram of durations (or any non-negative values). Buckets are powers of two 
+     * split into eight linear sub-buckets, so percentiles are accurate to within 12.5%.
+     * Values can be recorded from any thread without locking. Recording never allocates.
+     */
+    class LatencyHistogram{
+    public:
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram &other) = delete;
+        LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+        /**
+         * Add a value to the histogram
+         * @param value The value to add (ex: nanoseconds)
+         */
+        void record(uint64_t value);
+
+        /**
+         * Get the (approximate) value below which the given percentage of recorded values fall
+         * @param percentile Percentile to get (0 to 100)
+         * @return The upper bound of the bucket containing the percentile (0 if no values recorded)
+         */
+        uint64_t percentile(double percentile) const;
+
+        /**
+         * @return Number of recorded values
+         */
+        uint64_t count() const;
+
+        /**
+         * @return Smallest recorded value (0 if none recorded)
+         */
+        uint64_t min() const;
+
+        /**
+         * @return Largest recorded value
+         */
+        uint64_t max() const;
+
+        /**
+         * @return Average of recorded values (0 if none recorded)
+         */
+        double mean() const;
+
+        /**
+         * Remove all recorded values. Values recorded while resetting may or may not be kept.
+         */
+        void reset();
+
+    private:
+        static size_t bucketIndex(uint64_t value);
+        static uint64_t bucketUpperBound(size_t index);
+
+        static const size_t SUB_BUCKETS = 8;
+        static const size_t BUCKET_COUNT = 62 * SUB_BUCKETS;
+
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets;
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> minValue;
+        std::atomic<uint64_t> maxValue;
+    };
+
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace arpirobot{
+
+    /**
+     * \class LatencyTracer LatencyTracer.hpp arpirobot/core/diag/LatencyTracer.hpp
+     * 
+     * Measures the time from controller data arriving to the resulting motor output being written.
+     * Only active if RobotProfile::latencyTracing is true.
+     * 
+     * Each controller packet is tagged with a frame ID and its arrival time. When a Gamepad is read
+     * the frame is remembered for the calling thread. When a motor controller's speed is then set
+     * (on the same thread, eg. through a drive helper) the time the IO write completed is recorded 
+     * against that frame. Only the first write of each frame to each motor is recorded.
+     */
+    class LatencyTracer{
+    public:
+        /**
+         * One motor write caused by a controller frame
+         */
+        struct TraceRecord{
+            uint64_t frame;
+            int controller;
+            std::chrono::steady_clock::time_point arrivalTime;
+            std::chrono::steady_clock::time_point readTime;
+            std::chrono::steady_clock::time_point outputTime;
+            std::string device;
+        };
+
+        /**
+         * @return true if tracing is enabled (RobotProfile::latencyTracing)
+         */
+        static bool isEnabled();
+
+        /**
+         * Get the next frame ID for received controller data (called by the network thread)
+         */
+        static uint64_t nextFrame();
+
+        /**
+         * Note that controller data was read by the current thread
+         * @param frame The frame ID of the data (0 if the data was received without tracing)
+         * @param controller The controller number
+         * @param arrivalTime When the data was received
+         */
+        static void noteInput(uint64_t frame, int controller, std::chrono::steady_clock::time_point arrivalTime);
+
+        /**
+         * Note that an output was written by the current thread
+         * @param device Name of the device written
+         * @param lastFrame The last frame recorded for this device. Updated by this function.
+         */
+        static void noteOutput(const std::string &device, uint64_t &lastFrame);
+
+        /**
+         * Forget the frame read by the current thread (called between periodic functions so 
+         * unrelated writes are not attributed to old input)
+         */
+        static void clearContext();
+
+        /**
+         * @return Histogram of time from controller data arriving to a motor write completing (ns)
+         */
+        static const LatencyHistogram &getInputToOutputLatency();
+
+        /**
+         * @return Histogram of time from controller data arriving to it first being read by robot code (ns)
+         */
+        static const LatencyHistogram &getInputToReadLatency();
+
+        /**
+         * @return Copy of the most recent trace records (oldest first)
+         */
+        static std::vector<TraceRecord> getRecords();
+
+        /**
+         * Write the most recent trace records to a CSV file
+         * Columns: frame,controller,arrival_us,read_us,output_us,read_latency_us,output_latency_us,device
+         * @param filename The file to write
+         * @return true on success
+         */
+        static bool exportCsv(const std::string &filename);
+
+        /**
+         * Clear recorded histograms and records
+         */
+        static void reset();
+
+    private:
+        struct Context{
+            uint64_t frame = 0;
+            int controller = -1;
+            std::chrono::steady_clock::time_point arrivalTime;
+            std::chrono::steady_clock::time_point readTime;
+        };
+
+        static thread_local Context context;
+
+        static std::atomic<uint64_t> frameCounter;
+        static std::atomic<uint64_t> lastReadFrame;
+        static LatencyHistogram inputToOutput;
+        static LatencyHistogram inputToRead;
+
+        // Ring of most recent records (RobotProfile::latencyTraceRecords)
+        static std::mutex recordsLock;
+        static std::vector<TraceRecord> records;
+        static size_t nextRecord;
+    };
+
+}
@@ -40,6 +40,8 @@ namespace arpirobot{
         const static unsigned int GPIO_LOW = IoProvider::GPIO_LOW;
         const static unsigned int GPIO_HIGH = IoProvider::GPIO_HIGH;
 
+        typedef IoProvider::UartBuffer UartBuffer;
+
         const static char *PROVIDER_PIGPIO;      // PIGPIO library
         const static char *PROVIDER_LIBSOC;  // libsoc library
         const static char *PROVIDER_DUMMY;       // Fake provider. Prints log messages.
@@ -137,8 +139,12 @@ namespace arpirobot{
 
         static void uartWrite(unsigned int handle, char* buf, unsigned int count);
 
+        static void uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount);
+
         static unsigned int uartRead(unsigned int handle, char *buf, unsigned int count);
 
+        static unsigned int uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs);
+
         static void uartWriteByte(unsigned int handle, uint8_t b);
 
         static uint8_t uartReadByte(unsigned int handle);
@@ -38,6 +38,12 @@ namespace arpirobot {
         const static unsigned int GPIO_LOW = 0;
         const static unsigned int GPIO_HIGH = 1;
 
+        // One buffer of a vectored (multiple buffer) write
+        struct UartBuffer{
+            const char *buf;
+            unsigned int count;
+        };
+
     protected:
 
         // Protected default constructor ensures direct instantiation is not possible
@@ -111,8 +117,15 @@ namespace arpirobot {
 
         virtual void uartWrite(unsigned int handle, char* buf, unsigned int count) = 0;
 
+        // Write several buffers (in order) as if they were one buffer
+        virtual void uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount) = 0;
+
         virtual unsigned int uartRead(unsigned int handle, char *buf, unsigned int count) = 0;
 
+        // Wait up to timeoutMs for data, then read as much as is available (up to count bytes) without waiting further.
+        // Returns the number of bytes read (0 on timeout).
+        virtual unsigned int uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs) = 0;
+
         virtual void uartWriteByte(unsigned int handle, uint8_t b) = 0;
 
         virtual uint8_t uartReadByte(unsigned int handle) = 0;
@@ -100,8 +100,12 @@ namespace arpirobot{
 
         void uartWrite(unsigned int handle, char* buf, unsigned int count) override;
 
+        void uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount) override;
+
         unsigned int uartRead(unsigned int handle, char *buf, unsigned int count) override;
 
+        unsigned int uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs) override;
+
         void uartWriteByte(unsigned int handle, uint8_t b) override;
 
         uint8_t uartReadByte(unsigned int handle) override;
@@ -113,13 +113,23 @@ namespace arpirobot{
 
         void uartWrite(unsigned int handle, char* buf, unsigned int count) override;
 
+        void uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount) override;
+
         unsigned int uartRead(unsigned int handle, char *buf, unsigned int count) override;
 
+        unsigned int uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs) override;
+
         void uartWriteByte(unsigned int handle, uint8_t b) override;
 
         uint8_t uartReadByte(unsigned int handle) override;
 
     private:
+        // Write to a port, waiting for space in the OS buffer (up to WRITE_TIMEOUT_MS). Throws if not all written.
+        static void writeAll(serial::Serial *serial, const uint8_t *data, size_t count);
+
+        // How long a write may wait for the OS to accept the data
+        const static uint32_t WRITE_TIMEOUT_MS;
+
         // Map handles to serial instances
         std::unordered_map<int, serial::Serial*> handleMap;
         int currentHandle = 0;
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace arpirobot{
+
+    /**
+     * \class LogRateLimiter LogRateLimiter.hpp arpirobot/core/log/LogRateLimiter.hpp
+     *
+     * Token bucket limiting how often one log call site logs. Used by the ARPIROBOT_LOG_LIMITED macros,
+     * which create one (static) limiter per call site.
+     * Implemented as a generic cell rate algorithm (equivalent to a token bucket) so the whole
+     * bucket is one atomic value. Never blocks or allocates.
+     */
+    class LogRateLimiter{
+    public:
+        /**
+         * @param perSecond Messages allowed per second once the burst is used up
+         * @param burst Messages that can be logged at once
+         */
+        constexpr LogRateLimiter(int perSecond, int burst) :
+                intervalNs(1000000000LL / (perSecond > 0 ? perSecond : 1)),
+                toleranceNs((burst > 1 ? burst - 1 : 0) * (1000000000LL / (perSecond > 0 ? perSecond : 1))){
+
+        }
+
+        LogRateLimiter(const LogRateLimiter &other) = delete;
+        LogRateLimiter &operator=(const LogRateLimiter &other) = delete;
+
+        /**
+         * Take a token if one is available
+         * @param suppressed If allowed, set to the number of messages suppressed since the last allowed message
+         * @return true if the message should be logged
+         */
+        bool allow(uint64_t &suppressed){
+            int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t tat = nextAllowed.load(std::memory_order_relaxed);
+            while(true){
+                int64_t base = tat > now ? tat : now;
+                if(base - now > toleranceNs){
+                    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if(nextAllowed.compare_exchange_weak(tat, base + intervalNs, std::memory_order_relaxed))
+                    break;
+            }
+            suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * Add a note about suppressed messages to a message
+         */
+        static std::string withSuppressed(std::string message, uint64_t suppressed){
+            if(suppressed > 0)
+                message += " (suppressed " + std::to_string(suppressed) + " similar messages)";
+            return message;
+        }
+
+    private:
+        const int64_t intervalNs;
+        const int64_t toleranceNs;
+
+        // Theoretical arrival time. A message is allowed if now is at most toleranceNs before it.
+        std::atomic<int64_t> nextAllowed {0};
+        std::atomic<uint64_t> suppressedCount {0};
+    };
+
+}
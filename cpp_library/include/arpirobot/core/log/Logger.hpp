@@ -21,6 +21,85 @@
 
 #include <mutex>
 #include <string>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <arpirobot/core/log/LogRateLimiter.hpp>
+
+
+// Logging macros. The source and message are only evaluated if the message will be logged, so
+// these should be used instead of Logger::logXFrom where building the message is not free.
+// Debug messages are removed entirely when ARPIROBOT_STRIP_DEBUG_LOGS is defined (release builds of the library).
+
+#define ARPIROBOT_LOG(level, message) \
+    do{ \
+        if(::arpirobot::Logger::isEnabled(level)) \
+            ::arpirobot::Logger::write((level), "", (message)); \
+    }while(0)
+
+#define ARPIROBOT_LOG_FROM(level, source, message) \
+    do{ \
+        if(::arpirobot::Logger::anyEnabled(level)){ \
+            const std::string &arpirobotLogSource = (source); \
+            if(::arpirobot::Logger::isEnabled((level), arpirobotLogSource)) \
+                ::arpirobot::Logger::write((level), arpirobotLogSource, (message)); \
+        } \
+    }while(0)
+
+#ifdef ARPIROBOT_STRIP_DEBUG_LOGS
+    // Still type checked, but never evaluated
+    #define ARPIROBOT_LOG_DEBUG(message) \
+        do{ if(false) ::arpirobot::Logger::logDebug(message); }while(0)
+    #define ARPIROBOT_LOG_DEBUG_FROM(source, message) \
+        do{ if(false) ::arpirobot::Logger::logDebugFrom((source), (message)); }while(0)
+#else
+    #define ARPIROBOT_LOG_DEBUG(message) \
+        ARPIROBOT_LOG(::arpirobot::Logger::Level::Debug, message)
+    #define ARPIROBOT_LOG_DEBUG_FROM(source, message) \
+        ARPIROBOT_LOG_FROM(::arpirobot::Logger::Level::Debug, source, message)
+#endif
+
+// Rate limited logging for call sites that can run at loop rate (eg. IO errors). Each call site allows 
+// a burst of messages then perSecond messages per second. The next message logged after messages are
+// suppressed includes the number suppressed.
+#define ARPIROBOT_LOG_RATE_LIMITED_FROM(level, source, message, perSecond, burst) \
+    do{ \
+        if(::arpirobot::Logger::anyEnabled(level)){ \
+            static ::arpirobot::LogRateLimiter arpirobotLogLimiter((perSecond), (burst)); \
+            uint64_t arpirobotLogSuppressed; \
+            if(arpirobotLogLimiter.allow(arpirobotLogSuppressed)){ \
+                ARPIROBOT_LOG_FROM((level), (source), \
+                    ::arpirobot::LogRateLimiter::withSuppressed((message), arpirobotLogSuppressed)); \
+            } \
+        } \
+    }while(0)
+
+// Rate limited with defaults (burst of 5 then one per second)
+#define ARPIROBOT_LOG_LIMITED_FROM(level, source, message) \
+    ARPIROBOT_LOG_RATE_LIMITED_FROM(level, source, message, 1, 5)
+
+#ifdef ARPIROBOT_STRIP_DEBUG_LOGS
+    #define ARPIROBOT_LOG_DEBUG_FROM_LIMITED(source, message) \
+        do{ if(false) ::arpirobot::Logger::logDebugFrom((source), (message)); }while(0)
+#else
+    #define ARPIROBOT_LOG_DEBUG_FROM_LIMITED(source, message) \
+        ARPIROBOT_LOG_LIMITED_FROM(::arpirobot::Logger::Level::Debug, source, message)
+#endif
+#define ARPIROBOT_LOG_WARNING_FROM_LIMITED(source, message) \
+    ARPIROBOT_LOG_LIMITED_FROM(::arpirobot::Logger::Level::Warning, source, message)
+#define ARPIROBOT_LOG_ERROR_FROM_LIMITED(source, message) \
+    ARPIROBOT_LOG_LIMITED_FROM(::arpirobot::Logger::Level::Error, source, message)
+
+#define ARPIROBOT_LOG_INFO(message) ARPIROBOT_LOG(::arpirobot::Logger::Level::Info, message)
+#define ARPIROBOT_LOG_WARNING(message) ARPIROBOT_LOG(::arpirobot::Logger::Level::Warning, message)
+#define ARPIROBOT_LOG_ERROR(message) ARPIROBOT_LOG(::arpirobot::Logger::Level::Error, message)
+#define ARPIROBOT_LOG_INFO_FROM(source, message) \
+    ARPIROBOT_LOG_FROM(::arpirobot::Logger::Level::Info, source, message)
+#define ARPIROBOT_LOG_WARNING_FROM(source, message) \
+    ARPIROBOT_LOG_FROM(::arpirobot::Logger::Level::Warning, source, message)
+#define ARPIROBOT_LOG_ERROR_FROM(source, message) \
+    ARPIROBOT_LOG_FROM(::arpirobot::Logger::Level::Error, source, message)
+
 
 namespace arpirobot {
 
@@ -29,9 +108,23 @@ namespace arpirobot {
      * 
      * Helper class with static methods for logging messages.
      * Log messages will be printed to stdout and sent to a connected DS.
+     * Messages are added to a lock-free queue and written in batches by a background thread,
+     * so logging never waits for stdout or the network.
      */
     class Logger{
     public:
+        /**
+         * Message severity. Messages below the enabled level are not logged.
+         */
+        enum class Level {Debug = 0, Info = 1, Warning = 2, Error = 3, Off = 4};
+
+        /**
+         * What to do when a message is logged while the queue is full
+         */
+        enum class OverflowPolicy{
+            DROP_NEWEST,    // Drop the message being logged (a count of dropped messages is logged later)
+            BLOCK           // Wait until the background thread makes room
+        };
 
         /**
          * Log a debug message
@@ -90,9 +183,116 @@ namespace arpirobot {
          */
         static void logNewline();
 
+        /**
+         * Set the lowest level logged (default Debug). Applies to messages without a source and 
+         * sources without their own level.
+         * @param level The level
+         */
+        static void setLevel(Level level);
+
+        /**
+         * @return The lowest level logged for sources without their own level
+         */
+        static Level getLevel();
+
+        /**
+         * Set the lowest level logged for messages from a specific source
+         * @param source The source (often a device name)
+         * @param level The level
+         */
+        static void setSourceLevel(const std::string &source, Level level);
+
+        /**
+         * Use the global level for messages from a source again
+         * @param source The source (often a device name)
+         */
+        static void clearSourceLevel(const std::string &source);
+
+        /**
+         * Check if a message without a source would be logged
+         * @param level The message's level
+         */
+        static bool isEnabled(Level level){
+            return (int)level >= globalLevel.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Check if a message from the given source would be logged
+         * @param level The message's level
+         * @param source The message's source
+         */
+        static bool isEnabled(Level level, const std::string &source);
+
+        /**
+         * Check if a message at this level would be logged from any source. Cheap enough to
+         * call before building a message.
+         * @param level The message's level
+         */
+        static bool anyEnabled(Level level){
+            return (int)level >= minLevel.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Log a message without checking the level (used by the ARPIROBOT_LOG macros)
+         * @param level The message's level
+         * @param source The source of the message (empty string for none)
+         * @param message The message to log
+         */
+        static void write(Level level, const std::string &source, const std::string &message);
+
+        /**
+         * Set what happens when a message is logged while the queue is full (default DROP_NEWEST)
+         * @param policy The overflow policy
+         */
+        static void setOverflowPolicy(OverflowPolicy policy);
+
+        /**
+         * @return Number of messages dropped because the queue was full
+         */
+        static uint64_t getDroppedCount();
+
+        /**
+         * Wait until all messages logged before this call have been written
+         */
+        static void flush();
+
     private:
+        struct State;
+
         static void log(std::string message);
 
-        static std::mutex logMutex;
+        // Start background thread (first time something is logged)
+        static void start();
+
+        // Write any queued messages and stop background thread (at exit)
+        static void stop();
+
+        static void run();
+
+        static void wake();
+
+        // Lowest of the global and all source levels
+        static void updateMinLevel();
+
+        // Maximum number of messages written to stdout at once
+        static const size_t MAX_BATCH = 256;
+
+        static std::once_flag startFlag;
+        static State *state;
+        static std::atomic<bool> running;
+        static std::atomic<bool> sleeping;
+        static std::atomic<OverflowPolicy> overflowPolicy;
+        static std::atomic<uint64_t> queuedCount;
+        static std::atomic<uint64_t> writtenCount;
+        static std::atomic<uint64_t> droppedCount;
+
+        static std::atomic<int> globalLevel;
+        static std::atomic<int> minLevel;
+        static std::atomic<size_t> sourceLevelCount;
+        static std::unordered_map<std::string, int> sourceLevels;
+        static std::mutex levelMutex;
+
+        // Used once the background thread has stopped
+        static std::mutex directMutex;
     };
 }
\ No newline at end of file
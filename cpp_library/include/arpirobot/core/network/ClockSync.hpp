@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+namespace arpirobot{
+
+    /**
+     * \class ClockSync ClockSync.hpp arpirobot/core/network/ClockSync.hpp
+     * 
+     * Estimates the offset between the drive station's clock and the robot's steady clock so
+     * times sent by the drive station can be converted to robot time.
+     * 
+     * The robot periodically sends a ping with its send time (t1). The drive station replies with
+     * t1, the time it received the ping (t2) and the time it sent the reply (t3). The robot notes the 
+     * time it received the reply (t4). Only the samples with the smallest round trip time in a short 
+     * window are used (these are the least affected by queueing). Drift between the clocks is 
+     * estimated from how the offset changes over time.
+     * Only runs if the drive station supports it (see NetworkManager).
+     */
+    class ClockSync{
+    public:
+        /**
+         * @return true if at least one ping has completed since the drive station connected
+         */
+        static bool isSynced();
+
+        /**
+         * Get the current offset estimate (drive station clock minus robot clock)
+         * @return The offset in microseconds
+         */
+        static int64_t getOffsetUs();
+
+        /**
+         * Get the round trip time of the sample the offset estimate is based on
+         * @return Round trip time in microseconds (excluding time spent by the drive station)
+         */
+        static int64_t getRoundTripUs();
+
+        /**
+         * Get the maximum error of the offset estimate. Half of the round trip time plus the 
+         * effect of drift since the estimate was made.
+         * @return The error bound in microseconds
+         */
+        static int64_t getErrorBoundUs();
+
+        /**
+         * Get the estimated rate the drive station's clock drifts relative to the robot's
+         * @return Drift in parts per million (positive if the drive station's clock is faster)
+         */
+        static double getDriftPpm();
+
+        /**
+         * Convert a drive station time to robot steady clock time
+         * @param dsTimeUs Time on the drive station's clock (microseconds)
+         * @return Time on the robot's clock (microseconds since steady_clock epoch). Unchanged if not synced.
+         */
+        static int64_t toRobotTime(int64_t dsTimeUs);
+
+        /**
+         * @return Robot's steady clock time in microseconds (the clock used by clock sync)
+         */
+        static int64_t robotTimeUs();
+
+    private:
+        /**
+         * Build a ping command to send to the drive station
+         */
+        static std::string makePing();
+
+        /**
+         * Handle a ping reply from the drive station
+         * @param t1 Robot time the ping was sent
+         * @param t2 DS time the ping was received
+         * @param t3 DS time the reply was sent
+         * @param t4 Robot time the reply was received
+         */
+        static void handlePong(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+        /**
+         * Forget all samples (drive station disconnected)
+         */
+        static void reset();
+
+        // Must be called with lock held
+        static int64_t offsetAt(int64_t robotTime);
+
+        struct Sample{
+            int64_t robotTime;
+            int64_t offset;
+            int64_t rtt;
+        };
+
+        // Samples kept to choose the best (smallest round trip) sample from
+        static const int WINDOW_SIZE = 8;
+
+        // Minimum time between samples used to estimate drift (us)
+        static const int64_t DRIFT_MIN_SPAN_US = 10000000;
+
+        static std::mutex lock;
+        static Sample window[WINDOW_SIZE];
+        static int windowCount;
+        static int windowNext;
+        static bool synced;
+        static Sample best;
+        static Sample driftAnchor;
+        static double drift; // us per us
+        static bool hasDrift;
+
+        friend class NetworkManager;
+    };
+
+}
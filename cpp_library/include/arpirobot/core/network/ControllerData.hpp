@@ -21,9 +21,49 @@
 
 #include <mutex>
 #include <vector>
+#include <chrono>
+#include <cstdint>
 
 namespace arpirobot{
 
+    /**
+     * Link quality for a single controller. Only tracked when the drive station sends the 
+     * extended controller packet header (sequence number and send time).
+     */
+    struct ControllerLinkStats{
+        /// true if packets for this controller include the extended header
+        bool extended = false;
+
+        /// Sequence number of the last accepted packet
+        uint32_t lastSequence = 0;
+
+        /// Number of packets accepted
+        uint64_t received = 0;
+
+        /// Number of packets never received (gaps in sequence numbers)
+        uint64_t lost = 0;
+
+        /// Number of packets dropped because they were duplicates or older than an accepted packet
+        uint64_t outOfOrder = 0;
+
+        /// Number of packets dropped because they were delayed more than RobotProfile::maxGamepadDataAge
+        uint64_t late = 0;
+
+        /// Interarrival jitter (RFC 3550) in milliseconds
+        double jitterMs = 0;
+
+        /// Delay of the last packet (ms) compared to the fastest recent packet. This is the 
+        /// variable (queueing) part of the one way latency.
+        double relativeDelayMs = 0;
+
+        /// true if the robot's clock is synchronized with the drive station's (see ClockSync)
+        /// and latencyMs is valid
+        bool latencyValid = false;
+
+        /// Estimated one way latency of the last packet (ms)
+        double latencyMs = 0;
+    };
+
     ////////////////////////////////////////////////////////////////////////////
     /// ControllerData
     ////////////////////////////////////////////////////////////////////////////
@@ -47,6 +87,24 @@ namespace arpirobot{
          */
         void updateData(std::vector<uint8_t> &data);
 
+        /**
+         * Check the extended header of a packet before its data is used. Updates link statistics.
+         * @param sequence The packet's sequence number
+         * @param sendTime Time the drive station sent the packet (drive station clock, microseconds)
+         * @return true if the packet should be used. false if it is a duplicate, out of order, or late.
+         */
+        bool acceptPacket(uint32_t sequence, uint64_t sendTime);
+
+        /**
+         * Clear link statistics and sequence tracking (drive station disconnected)
+         */
+        void resetLink();
+
+        /**
+         * Get a copy of this controller's link statistics
+         */
+        ControllerLinkStats getLinkStats();
+
         int controllerNumber = -1;
         int axisCount = -1;
         int buttonCount = -1;
@@ -57,6 +115,24 @@ namespace arpirobot{
         std::vector<uint8_t> lastData;
         std::chrono::steady_clock::time_point lastUpdateTime;
         std::mutex lock;
+
+        // Latency tracing (see LatencyTracer). Frame is 0 if tracing is disabled.
+        uint64_t traceFrame = 0;
+        std::chrono::steady_clock::time_point arrivalTime;
+
+    private:
+        // A jump backwards in sequence numbers larger than this is treated as the DS restarting
+        static const int32_t SEQUENCE_RESET_THRESHOLD = 1000;
+
+        // Minimum transit time is tracked over two windows of this length so the baseline 
+        // follows drift between the robot and DS clocks
+        static const int64_t TRANSIT_WINDOW_US = 5000000;
+
+        ControllerLinkStats linkStats;
+        int64_t lastTransitUs = 0;
+        int64_t minTransitUs = 0;
+        int64_t prevMinTransitUs = 0;
+        int64_t transitWindowStartUs = 0;
     };
 
 }
\ No newline at end of file
@@ -26,10 +26,15 @@
 #include <mutex>
 #include <unordered_map>
 #include <memory>
+#include <atomic>
+#include <vector>
 
 #include <arpirobot/core/network/MainVmon.hpp>
 #include <arpirobot/core/network/ControllerData.hpp>
 #include <arpirobot/core/network/NetworkTable.hpp>
+#include <arpirobot/core/network/SendQueue.hpp>
+#include <arpirobot/core/network/RingBuffer.hpp>
+#include <arpirobot/core/diag/HandlerStats.hpp>
 
 using namespace asio::ip;
 using namespace asio;
@@ -40,6 +45,7 @@ namespace arpirobot{
     *
     * Networking protocol
     * The drive station uses four ports to communicate with the robot.
+    * The ports listed are defaults. The robot's ports and the address it listens on are set in RobotProfile.
     * Controller Port  (UDP 8090):
     *     Data is only received from the DS. Data is not sent from the robot to the DS on this port.
     *     The controller port is a UDP port on port 8090. It is used to send controller data in the following packet format
@@ -57,13 +63,24 @@ namespace arpirobot{
     *                     6  5  4
     *           Two dpads are sent per byte. As with the buttons the most significant 4 bits represent 
     *           the lowest numbered dpad.
+    *     Extended header: If the DS sends the "CTRL_EXT" command (only if the robot lists CTRL_EXT in the
+    *     "capabilities" net table key), every controller packet for the rest of the connection starts with
+    *     [version=1,seq (u32),sendTime (u64)] (big endian) followed by the packet above.
+    *     The sequence number increases by one for each packet sent for a controller. The send time is the
+    *     DS's clock in microseconds. Duplicate, out of order, and late packets are dropped by the robot.
     * Command port (TCP 8091):
-    *     Data is only received from the DS. Data is not sent from the robot to the DS on this port. Commands end with a newline.
+    *     Commands end with a newline. Data is only sent from the robot to the DS on this port for clock sync.
     *     Commands are sent to the robot on this port as ASCII strings
     *     Some commands include:
     *     "ENABLE" = Enable the robot
     *     "DISABLE" = Disable the robot
     *     "NT_SYNC" = Start network table sync (always triggered by drive station)
+    *     "NT_SYNC epoch:version" = Start versioned (incremental) network table sync (see net table port)
+    *     "CTRL_EXT" = DS will send extended controller packets (see controller port)
+    *     "CLOCK_SYNC" = DS supports clock sync (only sent if the robot lists CLOCK_SYNC in "capabilities").
+    *                    The robot will then periodically send "PING t1" on this port (t1 is the robot's
+    *                    time in microseconds). The DS must reply with "PONG t1 t2 t3" where t2 is the DS's time
+    *                    when the ping was received and t3 is the DS's time when the reply is sent (microseconds).
     * Net Table port (TCP 8092):
     *     Data is sent and received on the net table port.
     *     New keys are sent to the drive station in the format shown below
@@ -76,9 +93,34 @@ namespace arpirobot{
     *     net table sync stop sequence. The robot then waits for the drive station to send any key/value pairs
     *     that the robot is missing. The drive station then sends the net table sync stop sequence and the robot
     *     then "ends" the sync.
+    *     The robot does not hold the net table locked during a sync. A snapshot of the table is sent. Values
+    *     changed by the robot while the snapshot is being sent are sent once the sync finishes.
+    *     Versioned sync: Each key/value pair has a version. If the DS starts the sync with "NT_SYNC epoch:version"
+    *     the robot only sends pairs changed since that version (a full sync is sent if the epoch does not match
+    *     the robot's, eg the robot program restarted). The robot's stop sequence is then followed by
+    *     the epoch and version the DS now has ("\377\377\377epoch:version\n"). "NT_SYNC 0:0" requests a full,
+    *     versioned sync.
     * Log port  (TCP 8093):
     *     Log messages are sent as strings from the robot to the drive station on this port. No data is sent to the robot
     *     from the drive station on this port.
+    * Telemetry port (UDP 8094 on the drive station):
+    *     Data is only sent from the robot to the DS. Nothing is received by the robot on this port.
+    *     While a DS is connected, telemetry sources (see Telemetry) are sampled periodically and sent
+    *     to the DS's address on this port. All values are little endian.
+    *     ['T','L',version=1,recordCount,record1,record2,...]
+    *     Each record is [sourceId (u8),sequence (u32),timestamp (u64, robot steady clock in microseconds),field1 (f32),...]
+    *     The sequence number is per source. The number of fields for each source is fixed and is announced
+    *     using the net table key "telemetry_schema" in the format "id:name:field1,field2,...;id:name:field1,...".
+    *     Telemetry is also sent to this port on each connected subscriber's address.
+    * Subscriber port (TCP 8095):
+    *     Read-only clients (eg dashboards) can connect on this port at any time, including while a drive
+    *     station is connected. Subscribers can not control the robot. Data received from subscribers is ignored.
+    *     Each message sent to a subscriber starts with a one byte tag
+    *     'N',"[KEY]",255,"[VALUE]",'\n'   Net table key/value pair (same format as the net table port)
+    *     'L',"[MESSAGE]"                  Log message (ends with a newline)
+    *     When a subscriber connects all net table pairs are sent, then changes are sent as they are made
+    *     (by the robot or the drive station). A subscriber that does not read fast enough has older
+    *     messages dropped. It never delays the drive station or the robot.
     * 
     */
 
@@ -87,6 +129,12 @@ namespace arpirobot{
     const extern std::string COMMAND_ENABLE;
     const extern std::string COMMAND_DISABLE;
     const extern std::string COMMAND_NET_TABLE_SYNC;
+    const extern std::string COMMAND_CONTROLLER_EXT;
+    const extern std::string COMMAND_CLOCK_SYNC;
+    const extern std::string COMMAND_PONG;
+
+    // Net table key listing optional protocol features supported by the robot (space separated)
+    const extern std::string NET_TABLE_CAPABILITIES_KEY;
 
     // Pre-defined (special) data packets
     const extern uint8_t NET_TABLE_START_SYNC_DATA[];
@@ -109,27 +157,91 @@ namespace arpirobot{
         static void startNetworking(std::function<void()> enableFunc, std::function<void()> disableFunc);
 
         /**
-         * Stop networking
+         * Stop networking. Closes all sockets. Networking can be started again afterwards.
          */
         static void stopNetworking();
 
+        /**
+         * Get counters for data queued to be sent to the net table client
+         */
+        static SendQueueStats getNetTableSendStats();
+
+        /**
+         * Get counters for data queued to be sent to the log client
+         */
+        static SendQueueStats getLogSendStats();
+
+        /**
+         * Get the number of connected subscribers
+         */
+        static size_t getSubscriberCount();
+
+        /**
+         * Get counters for data queued to be sent to each connected subscriber
+         */
+        static std::vector<SendQueueStats> getSubscriberSendStats();
+
+        /**
+         * Get timing for handling controller data (one item per packet). Only recorded if
+         * RobotProfile::handlerStats is true.
+         */
+        static HandlerStats &getControllerHandlerStats();
+
+        /**
+         * Get timing for handling received net table data (one item per key/value pair or sync marker)
+         */
+        static HandlerStats &getNetTableHandlerStats();
+
+        /**
+         * Get timing for handling received commands (one item per command)
+         */
+        static HandlerStats &getCommandHandlerStats();
+
     private:
 
+        // A read-only client connected on the subscriber port
+        struct Subscriber{
+            Subscriber(io_service &io, size_t maxBytes);
+
+            tcp::socket socket;
+            SendQueue queue;
+            udp::endpoint telemetryEndpoint;
+            std::array<uint8_t, 64> rxBuf;
+        };
+
+        /**
+         * Queue raw net table data to be sent
+         * @param buffer Raw data to send to network table client (copied)
+         * @param droppable If false the data will be queued even if the send queue is full
+         */
+        static bool sendNtRaw(const_buffer buffer, bool droppable = true);
+
         /**
-         * Send raw net table data
-         * @param buffer Raw data to send to network table client
+         * Queue a network table key/value pair to be sent to the network table client and subscribers.
+         * A queued, unsent value for the same key will be replaced.
+         * @param key The key for the pair
+         * @param value The value for the pair
+         * @param droppable If false the data will be queued even if the drive station's send queue is full
+         */
+        static bool sendNt(const std::string &key, const std::string &value, bool droppable = true);
+
+        /**
+         * Queue a network table key/value pair to be sent to the network table client only.
+         * Used for net table sync. The data will be queued even if the send queue is full.
+         * @param key The key for the pair
+         * @param value The value for the pair
          */
-        static bool sendNtRaw(const_buffer buffer);
+        static bool sendNtSync(const std::string &key, const std::string &value);
 
         /**
-         * Send a network table key/value pair to the network table client
+         * Queue a network table key/value pair to be sent to subscribers only (changes made by the DS)
          * @param key The key for the pair
          * @param value The value for the pair
          */
-        static bool sendNt(std::string key, std::string value);
+        static void sendNtToSubscribers(const std::string &key, const std::string &value);
 
         /**
-         * Send a message to the log client
+         * Queue a message to be sent to the log client
          * @param message The message to send
          */
         static void sendLogMessage(std::string message);
@@ -158,6 +270,14 @@ namespace arpirobot{
          */
         static void runNetworking();
 
+        /**
+         * Open an acceptor and start listening
+         * @param acceptor The acceptor to open (left closed on failure)
+         * @param endpoint The address and port to listen on
+         * @param ec Set if the acceptor could not be opened
+         */
+        static void listen(tcp::acceptor &acceptor, const tcp::endpoint &endpoint, std::error_code &ec);
+
         /**
          * Handle data sent from client (async receive)
          * @param client The client to receive data from
@@ -173,14 +293,52 @@ namespace arpirobot{
 
         static void handleAccept(const tcp::socket &client, const std::error_code &ec);
         static void handleDisconnect(const tcp::socket &client);
+        static void handleWriteError(const tcp::socket &client, const std::error_code &ec);
         static void handleTcpReceive(const tcp::socket &client, const std::error_code &ec, std::size_t count);
         static void handleUdpReceive(const std::error_code &ec, std::size_t count);
 
-        static void handleCommand();
+        // Return the number of commands / lines handled
+        static size_t handleCommand();
+
+        static size_t handleNetTableData();
+
+        static bool bufferEquals(const char *buf, size_t len, const std::string &str);
+
+        static std::shared_ptr<const std::string> makeNtFrame(const std::string &key, const std::string &value);
+
+        // Subscriber handling (all on io thread except sendToSubscribers)
 
-        static void handleNetTableData();
+        static void acceptSubscriber();
+        static void handleSubscriberAccept(std::shared_ptr<Subscriber> subscriber, const std::error_code &ec);
+        static void handleSubscriberReceive(std::shared_ptr<Subscriber> subscriber, 
+            const std::error_code &ec, std::size_t count);
+        static void removeSubscriber(std::shared_ptr<Subscriber> subscriber);
+        static void reapSubscribers();
+        static void sendToSubscribers(const std::shared_ptr<const std::string> &frame, 
+            const std::string &key, const_buffer tag);
 
-        static void handleControllerData(std::vector<uint8_t> &data);
+        static void handleControllerData(std::vector<uint8_t> &data, std::chrono::steady_clock::time_point arrivalTime);
+
+        // Extended controller packet header [version, seq (4 bytes), sendTime (8 bytes)]
+        static const uint8_t CONTROLLER_EXT_VERSION = 1;
+        static const size_t CONTROLLER_EXT_HEADER_SIZE = 13;
+
+        /**
+         * Check if there is anywhere to send telemetry (drive station or subscribers)
+         */
+        static bool hasTelemetryClients();
+
+        /**
+         * Send a telemetry datagram to the drive station and subscribers (called from telemetry thread)
+         * @param data The datagram to send
+         * @return true if sent to at least one client
+         */
+        static bool sendTelemetry(const std::vector<uint8_t> &data);
+
+        /**
+         * Send a clock sync ping and schedule the next one
+         */
+        static void sendClockSyncPing(const std::error_code &ec);
 
         static std::unordered_map<int, std::shared_ptr<ControllerData>> controllerData;
 
@@ -188,21 +346,22 @@ namespace arpirobot{
         static std::thread *networkThread;
 
         // Status
-        static bool isDsConnected;
+        static std::atomic<bool> isDsConnected;
+        static std::atomic<bool> extendedControllerPackets;
         static bool networkingStarted;
 
         // TODO: Main vmon
 
         // Read buffers (only receive data from command, controller, net table ports)
-        static std::array<uint8_t, 32> tmpCommandRxBuf;
-        static std::array<uint8_t, 32> tmpNetTableRxBuf;
-        static std::array<uint8_t, 32> tmpControllerRxBuf;
-
-        // These hold data received from multiple packets (above buffers are one packet use)
-        static std::vector<uint8_t> commandRxData;
-        static std::vector<uint8_t> netTableRxData;
+        // TCP data is received directly into ring buffers and parsed in place. 
+        // Data can be split across or combined in packets, so unparsed data is left in the buffer
+        static RingBuffer commandRxBuffer;
+        static RingBuffer netTableRxBuffer;
+        static std::array<uint8_t, 1024> tmpControllerRxBuf; // Large enough for any controller (plus extended header)
+        static const size_t RX_READ_SIZE = 4096;
 
         // Boost ASIO stuff
+        // Sockets and acceptors are not opened until startNetworking
         static io_service io;
         static io_service::work wk; // Keep run from exiting
 
@@ -217,6 +376,30 @@ namespace arpirobot{
         static tcp::socket netTableClient;
         static tcp::socket logClient;
 
+        // Outbound data (written by io thread)
+        static SendQueue commandQueue;
+        static SendQueue netTableQueue;
+        static SendQueue logQueue;
+
+        static asio::steady_timer clockSyncTimer;
+        static int clockSyncPings;
+
+        // Telemetry is sent from its own socket (only used by the telemetry thread)
+        static udp::socket telemetrySocket;
+        static udp::endpoint telemetryEndpoint;
+        static std::vector<udp::endpoint> subscriberTelemetryEndpoints;
+        static std::mutex telemetryLock;
+
+        // Read-only subscribers. Removed subscribers are kept until their send queue is idle
+        // because pending writes reference the queue.
+        static tcp::acceptor subscriberAcceptor;
+        static std::vector<std::shared_ptr<Subscriber>> subscribers;
+        static std::vector<std::shared_ptr<Subscriber>> closedSubscribers;
+        static std::atomic<size_t> subscriberCount;
+        static std::mutex subscribersLock;
+        static const uint8_t SUBSCRIBER_NT_TAG[];
+        static const uint8_t SUBSCRIBER_LOG_TAG[];
+
         // Callback for enable and disable events (this are private functions in BaseRobot)
         // Doing this way makes it hard for other code to call enable / disable for the robot
         static std::function<void()> enableFunc;
@@ -226,10 +409,15 @@ namespace arpirobot{
 
         static MainVmon *mainVmon;
 
+        static HandlerStats controllerHandlerStats;
+        static HandlerStats netTableHandlerStats;
+        static HandlerStats commandHandlerStats;
+
 
         friend class MainVmon;
         friend class Logger;
         friend class NetworkTable;
         friend class Gamepad;
+        friend class Telemetry;
     };
 }
\ No newline at end of file
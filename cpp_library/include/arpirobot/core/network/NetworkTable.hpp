@@ -22,6 +22,9 @@
 #include <unordered_map>
 #include <string>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
 
 namespace arpirobot{
     /**
@@ -62,19 +65,49 @@ namespace arpirobot{
         static bool changed(std::string key);
 
     private:
+        /**
+         * A single value in the table. The version is taken from a table-wide counter
+         * each time the value changes, so entries changed after a given point can be found.
+         */
+        struct Entry{
+            std::string value;
+            uint64_t version;
+        };
+
+        typedef std::unordered_map<std::string, Entry> EntryMap;
+
         static bool isInSync();
-        static void startSync();
-        static void sendAllValues();
+
+        /**
+         * Start a sync with the drive station.
+         * @param sinceEpoch Table epoch the drive station last synced with (0 for a full sync)
+         * @param sinceVersion Last table version the drive station received (only used if epoch matches)
+         * @param versioned If true the end of sync sequence will include the table epoch and version
+         */
+        static void startSync(uint32_t sinceEpoch = 0, uint64_t sinceVersion = 0, bool versioned = false);
+        static void sendValues(const EntryMap &snapshot, bool incremental, uint64_t sinceVersion);
         static void finishSync(std::unordered_map<std::string, std::string> dataFromDs);
         static void abortSync();
 
         static void setFromRobot(std::string key, std::string value);
         static void setFromDs(std::string key, std::string value);
+        static void setFromDs(const char *key, size_t keyLen, const char *value, size_t valueLen);
+
+        // Must be called with lock held. Copies the map if a sync snapshot still references it.
+        static EntryMap &mutableData();
     
-        static std::unordered_map<std::string, std::string> data;
+        static std::shared_ptr<EntryMap> data;
         static std::unordered_map<std::string, bool> dataChanged;
         static std::mutex lock;
-        static bool inSync;
+        static std::atomic<bool> inSync;
+
+        // Version of the most recent change and the version the current sync snapshot was taken at
+        static uint64_t currentVersion;
+        static uint64_t syncVersion;
+
+        // Random per-process value. Lets the drive station detect that versions it holds are
+        // from a previous run of the robot program (and a full sync is required)
+        static const uint32_t epoch;
 
         friend class NetworkManager;
     };
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace arpirobot{
+
+    /**
+     * \class RingBuffer RingBuffer.hpp arpirobot/core/network/RingBuffer.hpp
+     * 
+     * Growable byte ring buffer used to parse data received from a stream (TCP socket).
+     * Data is received directly into the buffer (see prepare / commit) and complete messages are 
+     * found and read in place (see find / peek / consume).
+     * Not thread safe. Should not be used directly from user code.
+     */
+    class RingBuffer{
+    public:
+        /// Returned by find if the byte is not in the buffer
+        static const size_t npos = (size_t)-1;
+
+        /**
+         * @param initialCapacity Initial size of the buffer (rounded up to a power of two)
+         * @param maxCapacity The buffer will not grow beyond this size
+         */
+        RingBuffer(size_t initialCapacity = 4096, size_t maxCapacity = 1024 * 1024);
+
+        /**
+         * Get a contiguous region of free space to receive data into. 
+         * The buffer grows if less than minSize bytes are free (and the max capacity is not reached).
+         * @param minSize Desired amount of free space
+         * @return Region to receive into. Zero size if the buffer is full and cannot grow.
+         */
+        asio::mutable_buffer prepare(size_t minSize);
+
+        /**
+         * Mark bytes received into the region returned by prepare as readable
+         * @param count Number of bytes received
+         */
+        void commit(size_t count);
+
+        /**
+         * Find the first occurrence of a byte in the readable data
+         * @param b The byte to find
+         * @param start Offset (from the start of the readable data) to start searching at
+         * @return Offset of the byte from the start of the readable data or npos if not found
+         */
+        size_t find(uint8_t b, size_t start = 0) const;
+
+        /**
+         * Get a pointer to the first count readable bytes. If these bytes wrap around the end 
+         * of the buffer they are copied to a scratch buffer (reused across calls).
+         * The pointer is valid until the next non-const call.
+         * @param count Number of bytes needed (must be <= size())
+         */
+        const uint8_t *peek(size_t count);
+
+        /**
+         * Remove bytes from the start of the readable data
+         * @param count Number of bytes to remove
+         */
+        void consume(size_t count);
+
+        /**
+         * Remove all readable data
+         */
+        void clear();
+
+        /**
+         * @return Number of readable bytes
+         */
+        size_t size() const;
+
+        /**
+         * @return Current capacity of the buffer
+         */
+        size_t capacity() const;
+
+        /**
+         * @return true if the buffer is full and cannot grow (no data can be received)
+         */
+        bool full() const;
+
+    private:
+        void grow(size_t minCapacity);
+
+        std::vector<uint8_t> buffer;
+        std::vector<uint8_t> scratch;
+        size_t head = 0;    // Index of the first readable byte
+        size_t count = 0;   // Number of readable bytes
+        size_t maxCapacity;
+    };
+
+}
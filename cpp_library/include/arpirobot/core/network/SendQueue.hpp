@@ -0,0 +1,167 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+namespace arpirobot{
+
+    /**
+     * Counters for a SendQueue
+     */
+    struct SendQueueStats{
+        /// Bytes currently waiting to be sent (including bytes being written)
+        size_t queuedBytes = 0;
+
+        /// Frames currently waiting to be sent (including frames being written)
+        size_t queuedFrames = 0;
+
+        /// Total bytes written to the socket
+        uint64_t sentBytes = 0;
+
+        /// Total bytes dropped because the queue was over its byte budget
+        uint64_t droppedBytes = 0;
+
+        /// Total frames dropped because the queue was over its byte budget
+        uint64_t droppedFrames = 0;
+
+        /// Total frames replaced by a newer frame with the same key
+        uint64_t coalescedFrames = 0;
+    };
+
+    /**
+     * \class SendQueue SendQueue.hpp arpirobot/core/network/SendQueue.hpp
+     *
+     * Bounded outbound queue for a TCP socket. Frames can be added from any thread. They are
+     * written by the io_service thread using async_write with multiple frames gathered into one write.
+     * Should not be used directly from user code.
+     */
+    class SendQueue{
+    public:
+        /**
+         * What to do when adding a frame would exceed the queue's byte budget
+         */
+        enum class OverflowPolicy{
+            DROP_NEWEST,    // Drop the frame being added
+            DROP_OLDEST     // Drop the oldest queued frames (not yet being written) until the new one fits
+        };
+
+        /**
+         * @param io The io_service to run writes on
+         * @param maxBytes Byte budget for queued frames
+         * @param policy What to do when the budget is exceeded
+         */
+        SendQueue(asio::io_service &io, size_t maxBytes, OverflowPolicy policy);
+
+        SendQueue(const SendQueue &other) = delete;
+        SendQueue &operator=(const SendQueue &other) = delete;
+
+        /**
+         * Start writing queued frames to the given socket
+         * @param socket The socket to write to. Must stay valid until stop is called.
+         * @param errorHandler Called (on the io_service thread) if a write fails
+         */
+        void start(asio::ip::tcp::socket *socket, std::function<void(const std::error_code&)> errorHandler);
+
+        /**
+         * Stop writing and drop any frames that are not currently being written. The error handler
+         * is released and will not be called.
+         */
+        void stop();
+
+        /**
+         * Add a frame to the queue
+         * @param frame The data to send. Shared (not copied) until written.
+         * @param key If not empty, a queued frame with the same key that is not yet being written is
+         *            replaced by this frame (keeping its place in the queue)
+         * @param droppable If false this frame is queued even if it exceeds the byte budget and will
+         *                  not be dropped to make room for other frames
+         * @param prefix Data written immediately before the frame. Must refer to static data. Allows
+         *               one encoded frame to be shared by queues that need different framing.
+         * @return true if queued, false if dropped (or the queue is stopped)
+         */
+        bool enqueue(std::shared_ptr<const std::string> frame, const std::string &key = "", bool droppable = true, 
+            asio::const_buffer prefix = asio::const_buffer());
+
+        /**
+         * @return true if no write is in progress or pending. A queue must be stopped and idle
+         *         before it is destroyed.
+         */
+        bool idle();
+
+        /**
+         * Set the byte budget for this queue
+         */
+        void setMaxBytes(size_t maxBytes);
+
+        /**
+         * Get a copy of this queue's counters
+         */
+        SendQueueStats getStats();
+
+    private:
+        // Dropped items are left in the queue (with a null frame) until they reach the front
+        // so the position of an item can always be found from its sequence number
+        struct Item{
+            std::shared_ptr<const std::string> frame;
+            asio::const_buffer prefix;
+            std::string key;
+            bool droppable;
+            uint64_t seq;
+        };
+
+        // Must be called with lock held
+        static size_t itemSize(const Item &item);
+        void dropItem(Item &item);
+        void popFront();
+
+        void startWrite();
+        void handleWrite(const std::error_code &ec, std::size_t count);
+
+        // Maximum number of buffers (frames and prefixes) gathered into a single write
+        static const size_t MAX_GATHER = 64;
+
+        asio::io_service &io;
+        asio::ip::tcp::socket *socket = nullptr;
+        std::function<void(const std::error_code&)> errorHandler;
+
+        std::mutex lock;
+        std::deque<Item> items;
+        std::unordered_map<std::string, uint64_t> keySeqs;
+        uint64_t nextSeq = 0;
+        size_t maxBytes;
+        OverflowPolicy policy;
+        bool running = false;
+        bool writing = false;
+        bool restarted = false;     // start called while a write was in progress
+        size_t inFlight = 0;
+        std::vector<asio::const_buffer> gatherBuffers;
+        SendQueueStats stats;
+    };
+
+}
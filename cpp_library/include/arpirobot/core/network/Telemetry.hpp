@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace arpirobot{
+
+    /**
+     * \class Telemetry Telemetry.hpp arpirobot/core/network/Telemetry.hpp
+     * 
+     * High rate telemetry stream. Registered sources are sampled at a fixed rate 
+     * (RobotProfile::telemetryPeriod) and sent to the drive station (and any subscribers) as binary 
+     * records over UDP.
+     * Use this for data that changes too quickly to be sent using the NetworkTable (encoder counts, 
+     * IMU data, motor outputs, etc).
+     * 
+     * Each source has a fixed schema (list of fields, all sent as 32-bit floats). The schema for all
+     * sources is announced using the network table key "telemetry_schema" (see NetworkManager for format).
+     * Sources should be added before the robot is started. Many devices can add themselves 
+     * (eg QuadEncoder::addTelemetrySource).
+     */
+    class Telemetry{
+    public:
+
+        /**
+         * Add a telemetry source
+         * @param name The name of the source
+         * @param fields The names of each field in this source's records
+         * @param sampleFunc Function that writes the current value of each field (in order)
+         *                   to the given array. Called from the telemetry thread.
+         * @return The ID of the source (-1 if the source could not be added)
+         */
+        static int addSource(std::string name, std::vector<std::string> fields, 
+            std::function<void(float*)> sampleFunc);
+
+        /**
+         * Remove a telemetry source. Once this returns its sample function is no longer called.
+         * Source IDs are not reused.
+         * @param id The ID of the source (returned by addSource). Invalid IDs are ignored.
+         */
+        static void removeSource(int id);
+
+        /**
+         * Get the number of records sent
+         */
+        static uint64_t getSentRecords();
+
+        /**
+         * Get the number of datagrams that failed to send
+         */
+        static uint64_t getFailedSends();
+
+    private:
+        struct Source{
+            std::string name;
+            std::vector<std::string> fields;
+            std::function<void(float*)> sampleFunc;     // nullptr once removed
+            uint32_t seq;
+        };
+
+        /**
+         * Start sampling sources and sending records
+         */
+        static void start();
+
+        /**
+         * Stop sampling sources
+         */
+        static void stop();
+
+        static void run();
+
+        static void sampleAndSend();
+
+        static void announceSchema();
+
+        static std::string sanitize(std::string str);
+
+        static void appendU32(std::vector<uint8_t> &buf, uint32_t val);
+
+        static void appendU64(std::vector<uint8_t> &buf, uint64_t val);
+
+        // Keep datagrams under a typical MTU
+        static const size_t MAX_DATAGRAM_SIZE = 1400;
+        static const size_t MAX_FIELDS = 64;
+
+        static std::vector<Source> sources;
+        static std::mutex sourcesLock;
+        static std::thread *thread;
+        static std::atomic<bool> running;
+        static std::atomic<uint64_t> sentRecords;
+        static std::atomic<uint64_t> failedSends;
+        static std::vector<uint8_t> datagram;
+        static std::vector<float> sampleBuf;
+
+        friend class BaseRobot;
+    };
+
+}
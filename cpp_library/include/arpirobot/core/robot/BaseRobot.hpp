@@ -22,7 +22,9 @@
 #include <arpirobot/core/device/BaseDevice.hpp>
 #include <arpirobot/core/robot/RobotProfile.hpp>
 #include <arpirobot/core/scheduler.hpp>
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
 #include <chrono>
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <vector>
@@ -56,6 +58,12 @@ namespace arpirobot{
          */
         void start();
 
+        /**
+         * Get the time from an enable or disable command being received until the robot's state
+         * changed (robotEnabled / robotDisabled returned). Values are in nanoseconds.
+         */
+        const LatencyHistogram &getStateChangeLatency();
+
         /**
          * Schedule a function to be run at a given rate.
          * @param func The function to run
@@ -141,6 +149,17 @@ namespace arpirobot{
 
         void onEnable();
 
+        /**
+         * Request an enable or disable. Called from the network thread. Returns immediately.
+         * @param enable true to enable, false to disable
+         */
+        void requestStateChange(bool enable);
+
+        /**
+         * Apply the most recently requested state (on a scheduler thread)
+         */
+        void processStateChanges();
+
         ////////////////////////////////////////////////////////////////////////////
         /// Member variables
         ////////////////////////////////////////////////////////////////////////////
@@ -148,6 +167,16 @@ namespace arpirobot{
         // Status
         bool isEnabled = false;
 
+        // Latest enable / disable request. Bit 0 is the requested state (1 = enable). The other bits
+        // are the arrival time (steady clock ns), which also identifies the request (always increases).
+        // Only the latest request matters, so requests not yet applied are replaced.
+        // Only one thread applies requests at a time. 0 = no request.
+        std::atomic<uint64_t> stateRequest {0};
+        std::atomic<uint64_t> appliedStateRequest {0};
+        std::atomic<bool> stateChangeScheduled {false};
+        std::atomic<bool> processingStateChanges {false};
+        LatencyHistogram stateChangeLatency;
+
         // Watchdog
         std::mutex watchdogMutex;
         std::chrono::steady_clock::time_point lastWatchdogFeed;
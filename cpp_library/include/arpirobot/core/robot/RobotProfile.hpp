@@ -47,5 +47,62 @@ namespace arpirobot{
 
         /// Name of the IO provider to use (empty string for default)
         static std::string ioProvider;
+
+        /// Address the robot listens for the drive station and subscribers on ("0.0.0.0" for all interfaces)
+        static std::string networkBindAddress;
+
+        /// UDP port controller data is received on
+        static int controllerPort;
+
+        /// TCP port the drive station connects to for commands
+        static int commandPort;
+
+        /// TCP port the drive station connects to for net table data
+        static int netTablePort;
+
+        /// TCP port the drive station connects to for log messages
+        static int logPort;
+
+        /// Maximum bytes of net table data queued to be sent to the drive station
+        static int netTableSendBufferSize;
+
+        /// Maximum bytes of log messages queued to be sent to the drive station
+        static int logSendBufferSize;
+
+        /// Maximum number of log messages waiting to be written (read when the first message is logged)
+        static int logQueueSize;
+
+        /// UDP port on the drive station telemetry is sent to
+        static int telemetryPort;
+
+        /// Rate telemetry sources are sampled and sent at (ms)
+        static int telemetryPeriod;
+
+        /// TCP port read-only subscribers (dashboards) connect to
+        static int subscriberPort;
+
+        /// Maximum number of subscribers connected at once
+        static int maxSubscribers;
+
+        /// Maximum bytes of data queued to be sent to each subscriber
+        static int subscriberSendBufferSize;
+
+        /// Time between clock sync pings to the drive station (ms)
+        static int clockSyncPeriod;
+
+        /// Time network data handlers (see NetworkManager::getControllerHandlerStats)
+        static bool handlerStats;
+
+        /// Trace latency from controller data arriving to motor outputs (see LatencyTracer)
+        static bool latencyTracing;
+
+        /// Number of most recent latency trace records to keep
+        static int latencyTraceRecords;
+
+        /// File to continuously record robot activity to (empty string to disable). See FlightRecorder.
+        static std::string flightRecorderFile;
+
+        /// Size of the flight recorder file (bytes). Older records are overwritten once full.
+        static int flightRecorderSize;
     };
 }
\ No newline at end of file
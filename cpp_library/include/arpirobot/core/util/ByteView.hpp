@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace arpirobot{
+
+    /**
+     * \class ByteView ByteView.hpp arpirobot/core/util/ByteView.hpp
+     *
+     * Non-owning, read only view of a contiguous range of bytes (such as part of a std::vector).
+     * Cheap to copy. The viewed bytes must outlive the view.
+     */
+    class ByteView{
+    public:
+        constexpr ByteView() = default;
+
+        constexpr ByteView(const uint8_t *data, size_t size) : ptr(data), len(size){
+
+        }
+
+        /**
+         * View all bytes of a vector. The view is invalid once the vector is modified.
+         */
+        ByteView(const std::vector<uint8_t> &data) : ptr(data.data()), len(data.size()){
+
+        }
+
+        constexpr const uint8_t *data() const{
+            return ptr;
+        }
+
+        constexpr size_t size() const{
+            return len;
+        }
+
+        constexpr bool empty() const{
+            return len == 0;
+        }
+
+        constexpr const uint8_t &operator[](size_t index) const{
+            return ptr[index];
+        }
+
+        constexpr const uint8_t *begin() const{
+            return ptr;
+        }
+
+        constexpr const uint8_t *end() const{
+            return ptr + len;
+        }
+
+        /**
+         * @param offset Index of the first byte of the subview (at most size())
+         * @param count Maximum number of bytes in the subview
+         * @return View of bytes [offset, offset + count) of this view (clamped to this view)
+         */
+        constexpr ByteView subview(size_t offset, size_t count = SIZE_MAX) const{
+            return offset >= len ? ByteView(ptr + len, 0) : ByteView(ptr + offset, count < len - offset ? count : len - offset);
+        }
+
+        /**
+         * @return Copy of the viewed bytes
+         */
+        std::vector<uint8_t> toVector() const{
+            return std::vector<uint8_t>(begin(), end());
+        }
+
+    private:
+        const uint8_t *ptr = nullptr;
+        size_t len = 0;
+    };
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace arpirobot{
+
+    /**
+     * \class Crc16 Crc16.hpp arpirobot/core/util/Crc16.hpp
+     *
+     * CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, not reflected, no final xor).
+     * This is the CRC used to check messages sent between the pi and an arduino.
+     *
+     * ccittFalse uses the fastest implementation available on the current CPU. The others are
+     * public so they can be compared (see the crc-bench tool). All give the same results.
+     * A CRC can be computed in pieces by passing the result of one call as the crc of the next.
+     */
+    class Crc16{
+    public:
+        const static uint16_t CCITT_FALSE_INIT = 0xFFFF;
+
+        /**
+         * Calculate a CRC using the fastest available implementation
+         * @param data Data to calculate the CRC of
+         * @param len Number of bytes of data
+         * @param crc Initial value (or the CRC of the preceding data)
+         * @return The CRC
+         */
+        static uint16_t ccittFalse(const uint8_t *data, size_t len, uint16_t crc = CCITT_FALSE_INIT);
+
+        /**
+         * Calculate a CRC one bit at a time (reference implementation)
+         */
+        static uint16_t ccittFalseBitwise(const uint8_t *data, size_t len, uint16_t crc = CCITT_FALSE_INIT);
+
+        /**
+         * Calculate a CRC using lookup tables, eight bytes at a time (slice-by-8)
+         */
+        static uint16_t ccittFalseTable(const uint8_t *data, size_t len, uint16_t crc = CCITT_FALSE_INIT);
+
+        /**
+         * Calculate a CRC using ARMv8 carry-less multiply instructions (PMULL).
+         * Same as ccittFalseTable if hasPmull returns false.
+         */
+        static uint16_t ccittFalsePmull(const uint8_t *data, size_t len, uint16_t crc = CCITT_FALSE_INIT);
+
+        /**
+         * @return true if this CPU supports PMULL (and the library was built for ARMv8)
+         */
+        static bool hasPmull();
+    };
+}
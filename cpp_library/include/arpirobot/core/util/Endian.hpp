@@ -0,0 +1,149 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace arpirobot{
+
+    /**
+     * Byte order of multi-byte values in a message
+     */
+    enum class ByteOrder {Little = 0, Big = 1};
+
+    /**
+     * \class Endian Endian.hpp arpirobot/core/util/Endian.hpp
+     *
+     * Read and write integers and floats of a specific byte order to / from raw bytes. Works the same
+     * regardless of the byte order of the CPU. Nothing is allocated (except by append).
+     * Integer conversions are constexpr. Floats are assumed to be IEEE 754.
+     */
+    class Endian{
+    public:
+        /**
+         * Read a value stored little endian
+         * @param data Pointer to the first byte (at least sizeof(T) bytes)
+         */
+        template <typename T>
+        static constexpr T readLittle(const uint8_t *data){
+            typedef typename Bits<T>::Type U;
+            U u = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+                u |= (U)data[i] << (8 * i);
+            return fromBits<T>(u, std::is_floating_point<T>());
+        }
+
+        /**
+         * Read a value stored big endian
+         * @param data Pointer to the first byte (at least sizeof(T) bytes)
+         */
+        template <typename T>
+        static constexpr T readBig(const uint8_t *data){
+            typedef typename Bits<T>::Type U;
+            U u = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+                u = (U)(u << 8) | data[i];
+            return fromBits<T>(u, std::is_floating_point<T>());
+        }
+
+        /**
+         * Write a value little endian
+         * @param out Pointer to the first byte to write (sizeof(T) bytes are written)
+         */
+        template <typename T>
+        static constexpr void writeLittle(uint8_t *out, T value){
+            auto u = toBits(value, std::is_floating_point<T>());
+            for(size_t i = 0; i < sizeof(T); ++i)
+                out[i] = (uint8_t)(u >> (8 * i));
+        }
+
+        /**
+         * Write a value big endian
+         * @param out Pointer to the first byte to write (sizeof(T) bytes are written)
+         */
+        template <typename T>
+        static constexpr void writeBig(uint8_t *out, T value){
+            auto u = toBits(value, std::is_floating_point<T>());
+            for(size_t i = 0; i < sizeof(T); ++i)
+                out[i] = (uint8_t)(u >> (8 * (sizeof(T) - 1 - i)));
+        }
+
+        template <typename T>
+        static T read(const uint8_t *data, ByteOrder order){
+            return order == ByteOrder::Little ? readLittle<T>(data) : readBig<T>(data);
+        }
+
+        template <typename T>
+        static void write(uint8_t *out, T value, ByteOrder order){
+            if(order == ByteOrder::Little)
+                writeLittle(out, value);
+            else
+                writeBig(out, value);
+        }
+
+        /**
+         * Add a value to the end of a message
+         */
+        template <typename T>
+        static void append(std::vector<uint8_t> &out, T value, ByteOrder order){
+            size_t pos = out.size();
+            out.resize(pos + sizeof(T));
+            write(&out[pos], value, order);
+        }
+
+    private:
+        // Unsigned integer with the same size as T
+        template <typename T, size_t Size = sizeof(T)>
+        struct Bits{};
+
+        template <typename T> struct Bits<T, 1>{ typedef uint8_t Type; };
+        template <typename T> struct Bits<T, 2>{ typedef uint16_t Type; };
+        template <typename T> struct Bits<T, 4>{ typedef uint32_t Type; };
+        template <typename T> struct Bits<T, 8>{ typedef uint64_t Type; };
+
+        template <typename T>
+        static constexpr T fromBits(typename Bits<T>::Type u, std::false_type){
+            return (T)u;
+        }
+
+        template <typename T>
+        static T fromBits(typename Bits<T>::Type u, std::true_type){
+            T value;
+            std::memcpy(&value, &u, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        static constexpr typename Bits<T>::Type toBits(T value, std::false_type){
+            return (typename Bits<T>::Type)value;
+        }
+
+        template <typename T>
+        static typename Bits<T>::Type toBits(T value, std::true_type){
+            typename Bits<T>::Type u;
+            std::memcpy(&u, &value, sizeof(T));
+            return u;
+        }
+    };
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <arpirobot/core/util/Endian.hpp>
+#include <arpirobot/core/util/ByteView.hpp>
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Describe a field of a FrameLayout. The field is stored in the frame with the same type as the member.
+ * @param S The struct the frame is decoded into
+ * @param member Name of the member of S
+ */
+#define ARPIROBOT_FRAME_FIELD(S, member) arpirobot::FrameField<S, decltype(S::member), &S::member>
+
+namespace arpirobot{
+
+    /**
+     * \class FrameField FrameLayout.hpp arpirobot/core/util/FrameLayout.hpp
+     *
+     * One field of a FrameLayout (a member of S of type T). Use ARPIROBOT_FRAME_FIELD instead of
+     * using this directly.
+     */
+    template <typename S, typename T, T S::*Member>
+    struct FrameField{
+        constexpr static size_t SIZE = sizeof(T);
+
+        static void decode(const uint8_t *data, ByteOrder order, S &out){
+            out.*Member = Endian::read<T>(data, order);
+        }
+
+        static void encode(const S &in, ByteOrder order, uint8_t *out){
+            Endian::write(out, in.*Member, order);
+        }
+    };
+
+    namespace internal{
+        constexpr size_t sum(){
+            return 0;
+        }
+
+        template <typename... Sizes>
+        constexpr size_t sum(size_t first, Sizes... rest){
+            return first + sum(rest...);
+        }
+    }
+
+    /**
+     * \class FrameLayout FrameLayout.hpp arpirobot/core/util/FrameLayout.hpp
+     *
+     * Describes the layout of a fixed size frame of data: each field in order with no padding, all using the same
+     * byte order. A whole struct is decoded in one pass directly from the received bytes (no copies or allocations).
+     *
+     * Example:
+     * \code
+     * struct EncoderFrame{ int32_t count; float velocity; };
+     * typedef FrameLayout<ByteOrder::Little, EncoderFrame,
+     *     ARPIROBOT_FRAME_FIELD(EncoderFrame, count),
+     *     ARPIROBOT_FRAME_FIELD(EncoderFrame, velocity)> EncoderLayout;
+     * \endcode
+     *
+     * @tparam Order Byte order of every field
+     * @tparam S Struct the frame is decoded into
+     * @tparam Fields FrameFields in the order they appear in the frame
+     */
+    template <ByteOrder Order, typename S, typename... Fields>
+    class FrameLayout{
+    public:
+        /**
+         * Number of bytes in a frame
+         */
+        constexpr static size_t SIZE = internal::sum(Fields::SIZE...);
+
+        /**
+         * Decode a frame. Bytes after the frame are ignored.
+         * @param data The frame's data. Must be at least SIZE bytes.
+         * @param out Struct to decode into. Not modified if there is not enough data.
+         * @return true if decoded, false if data is too short
+         */
+        static bool decode(ByteView data, S &out){
+            if(data.size() < SIZE)
+                return false;
+            const uint8_t *ptr = data.data();
+            // Evaluated in order (fields are decoded in order, offsets are constants once inlined)
+            int expand[] = {0, (Fields::decode(ptr, Order, out), ptr += Fields::SIZE, 0)...};
+            (void)expand;
+            return true;
+        }
+
+        /**
+         * Encode a frame
+         * @param in Struct to encode
+         * @param out Where to write the frame (SIZE bytes are written)
+         */
+        static void encode(const S &in, uint8_t *out){
+            int expand[] = {0, (Fields::encode(in, Order, out), out += Fields::SIZE, 0)...};
+            (void)expand;
+        }
+    };
+}
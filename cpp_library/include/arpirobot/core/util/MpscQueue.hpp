@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace arpirobot{
+
+    /**
+     * \class MpscQueue MpscQueue.hpp arpirobot/core/util/MpscQueue.hpp
+     *
+     * Bounded lock-free queue for any number of producer threads and one consumer thread.
+     * Each slot has a sequence number so producers only contend on claiming a position
+     * (one compare and swap). Neither push nor pop ever blocks or allocates.
+     * @tparam T Type of queued items (must be default constructible and movable)
+     */
+    template <typename T>
+    class MpscQueue{
+    public:
+        /**
+         * @param capacity Maximum number of queued items (rounded up to a power of two)
+         */
+        explicit MpscQueue(size_t capacity){
+            size_t size = 2;
+            while(size < capacity)
+                size <<= 1;
+            mask = size - 1;
+            cells.reset(new Cell[size]);
+            for(size_t i = 0; i < size; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue &other) = delete;
+        MpscQueue &operator=(const MpscQueue &other) = delete;
+
+        /**
+         * Add an item (any thread)
+         * @param item The item to add (moved from if added)
+         * @return false if the queue is full (item not added)
+         */
+        bool push(T &&item){
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            Cell *cell;
+            while(true){
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if(diff == 0){
+                    // Slot is free. Claim it (pos is updated if another producer got it first).
+                    if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }else if(diff < 0){
+                    // Slot still holds an item from the previous lap
+                    return false;
+                }else{
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(item);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Remove the oldest item (consumer thread only)
+         * @param item Set to the removed item
+         * @return false if the queue is empty or the oldest item is still being added
+         */
+        bool pop(T &item){
+            Cell &cell = cells[dequeuePos & mask];
+            if(cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+                return false;
+            item = std::move(cell.data);
+            cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            dequeuePos++;
+            return true;
+        }
+
+        /**
+         * @return true if pop would fail (consumer thread only)
+         */
+        bool empty() const{
+            return cells[dequeuePos & mask].sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+        }
+
+        /**
+         * @return Maximum number of queued items
+         */
+        size_t capacity() const{
+            return mask + 1;
+        }
+
+    private:
+        struct Cell{
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        static const size_t CACHE_LINE = 64;
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+
+        // Producers share enqueuePos. dequeuePos is only used by the consumer. Each is padded onto its
+        // own cache line (alignas is not used since operator new does not honor it before C++17).
+        char cellsPad[CACHE_LINE];
+        std::atomic<size_t> enqueuePos {0};
+        char enqueuePad[CACHE_LINE - sizeof(std::atomic<size_t>)];
+        size_t dequeuePos = 0;
+    };
+
+}
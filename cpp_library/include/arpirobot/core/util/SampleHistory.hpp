@@ -0,0 +1,213 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include <arpirobot/core/util/SeqLock.hpp>
+
+namespace arpirobot{
+
+    /**
+     * A sensor reading and when it was taken
+     */
+    template <typename T>
+    struct TimedSample{
+        T value;
+
+        // When the data was received (time the bytes were read from the interface)
+        std::chrono::steady_clock::time_point hostTime;
+
+        // Time on the device's clock (microseconds, wraps around). Only valid if hasDeviceTime is true.
+        uint32_t deviceTime = 0;
+        bool hasDeviceTime = false;
+    };
+
+    /**
+     * \class SampleHistory SampleHistory.hpp arpirobot/core/util/SampleHistory.hpp
+     *
+     * Fixed size history of the most recent timestamped samples from a sensor.
+     * There must be only one writer thread (calling push). Any number of threads may read at the same time.
+     * Nothing blocks or allocates. Each kept sample is held in a SeqLock, so a reader never sees part of a sample.
+     * @tparam T Type of the sample value (must be trivially copyable)
+     * @tparam Capacity Number of samples kept (must be a power of two)
+     */
+    template <typename T, size_t Capacity>
+    class SampleHistory{
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(std::is_trivially_copyable<T>::value, "Sample values must be trivially copyable");
+    public:
+        typedef TimedSample<T> Sample;
+        typedef std::chrono::steady_clock::time_point TimePoint;
+
+        SampleHistory() = default;
+        SampleHistory(const SampleHistory &other) = delete;
+        SampleHistory &operator=(const SampleHistory &other) = delete;
+
+        /**
+         * Add a sample, replacing the oldest one if full (writer thread only)
+         * Samples must be pushed in order of hostTime.
+         */
+        void push(const Sample &sample){
+            uint64_t n = total.load(std::memory_order_relaxed);
+            Entry entry;
+            entry.index = n;
+            entry.sample = sample;
+            slots[n & (Capacity - 1)].store(entry);
+            total.store(n + 1, std::memory_order_release);
+        }
+
+        /**
+         * Get the most recent sample
+         * @param out Set to the sample
+         * @return false if there are no samples yet (out unchanged)
+         */
+        bool latest(Sample &out) const{
+            return get(0, out);
+        }
+
+        /**
+         * Get the most recent sample and how long ago it was received
+         * @param out Set to the sample
+         * @param age Set to the time since the sample was received
+         * @return false if there are no samples yet (out and age unchanged)
+         */
+        bool latestWithAge(Sample &out, std::chrono::steady_clock::duration &age) const{
+            if(!get(0, out))
+                return false;
+            age = std::chrono::steady_clock::now() - out.hostTime;
+            return true;
+        }
+
+        /**
+         * Get a sample by how many samples ago it was received
+         * @param back 0 for the most recent sample, 1 for the one before that, ...
+         * @param out Set to the sample
+         * @return false if there is no such sample (not received yet or no longer kept)
+         */
+        bool get(size_t back, Sample &out) const{
+            while(true){
+                uint64_t n = total.load(std::memory_order_acquire);
+                if(back >= n || back >= Capacity)
+                    return false;
+                uint64_t index = n - 1 - back;
+                if(read(index, out))
+                    return true;
+                // Overwritten by newer samples while reading. Try again with the new most recent sample.
+            }
+        }
+
+        /**
+         * Get the sample that was current at a given time (the most recent one received at or before t)
+         * @param t The time
+         * @param out Set to the sample
+         * @return false if no kept sample was received at or before t
+         */
+        bool getSampleAt(TimePoint t, Sample &out) const{
+            Sample s;
+            for(size_t back = 0; get(back, s); ++back){
+                if(s.hostTime <= t){
+                    out = s;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Get the samples received just before and just after a given time (to interpolate between them)
+         * @param t The time
+         * @param before Set to the most recent sample received at or before t
+         * @param after Set to the sample received after before
+         * @return false if t is not between two kept samples (before and after unchanged)
+         */
+        bool getSamplesAround(TimePoint t, Sample &before, Sample &after) const{
+            Sample newer, s;
+            bool haveNewer = false;
+            for(size_t back = 0; get(back, s); ++back){
+                if(s.hostTime <= t){
+                    if(!haveNewer)
+                        return false;
+                    before = s;
+                    after = newer;
+                    return true;
+                }
+                newer = s;
+                haveNewer = true;
+            }
+            return false;
+        }
+
+        /**
+         * Position of t between two samples for linear interpolation
+         * @return 0 at before.hostTime, 1 at after.hostTime
+         */
+        static double interpolationFactor(const Sample &before, const Sample &after, TimePoint t){
+            auto span = after.hostTime - before.hostTime;
+            if(span.count() <= 0)
+                return 1.0;
+            return std::chrono::duration<double>(t - before.hostTime) / std::chrono::duration<double>(span);
+        }
+
+        /**
+         * @return Number of samples currently kept
+         */
+        size_t size() const{
+            uint64_t n = total.load(std::memory_order_acquire);
+            return n < Capacity ? (size_t)n : Capacity;
+        }
+
+        /**
+         * @return Number of samples ever pushed
+         */
+        uint64_t totalSamples() const{
+            return total.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct Entry{
+            uint64_t index = 0;
+            Sample sample;
+        };
+
+        // Read the sample with the given index. false if the slot no longer holds it (overwritten by newer samples).
+        bool read(uint64_t index, Sample &out) const{
+            Entry entry = slots[index & (Capacity - 1)].load();
+            if(entry.index != index)
+                return false;
+            out = entry.sample;
+            return true;
+        }
+
+        static const size_t CACHE_LINE = 64;
+
+        // Keeps total off the cache line of whatever precedes this object (alignas is not used
+        // since operator new does not honor it before C++17)
+        char totalPad[CACHE_LINE];
+        std::atomic<uint64_t> total {0};
+        std::array<SeqLock<Entry>, Capacity> slots;
+    };
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+namespace arpirobot{
+
+    /**
+     * \class SeqLock SeqLock.hpp arpirobot/core/util/SeqLock.hpp
+     *
+     * Holds a value that is written by one thread and read by any number of threads. Readers always get a
+     * complete value from a single store (never part of one value and part of another).
+     * Readers never lock. If a store happens while reading, the read is retried.
+     * There must be only one writer thread at a time.
+     * @tparam T Type of the value (must be trivially copyable)
+     */
+    template <typename T>
+    class SeqLock{
+        static_assert(std::is_trivially_copyable<T>::value, "SeqLock values must be trivially copyable");
+    public:
+        /**
+         * Initially holds a value initialized T (zero for structs of numbers)
+         */
+        SeqLock(){
+            store(T());
+        }
+
+        explicit SeqLock(const T &initial){
+            store(initial);
+        }
+
+        SeqLock(const SeqLock &other) = delete;
+        SeqLock &operator=(const SeqLock &other) = delete;
+
+        /**
+         * Replace the value (writer thread only)
+         */
+        void store(const T &value){
+            Word buf[WORDS] = {};
+            std::memcpy(buf, &value, sizeof(T));
+            uint32_t s = seq.load(std::memory_order_relaxed);
+            seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for(size_t i = 0; i < WORDS; ++i)
+                words[i].store(buf[i], std::memory_order_relaxed);
+            seq.store(s + 2, std::memory_order_release);
+        }
+
+        /**
+         * @return A copy of the value (any thread)
+         */
+        T load() const{
+            Word buf[WORDS];
+            uint32_t s1, s2;
+            do{
+                s1 = seq.load(std::memory_order_acquire);
+                for(size_t i = 0; i < WORDS; ++i)
+                    buf[i] = words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                s2 = seq.load(std::memory_order_relaxed);
+            }while((s1 & 1) || s1 != s2);
+            T value;
+            std::memcpy(&value, buf, sizeof(T));
+            return value;
+        }
+
+    private:
+        // The value is copied in and out a word at a time using atomics so that reading while
+        // the writer is storing is not a data race (the retry discards such reads).
+        typedef uintptr_t Word;
+        const static size_t WORDS = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+        // Odd while a store is in progress
+        std::atomic<uint32_t> seq {0};
+        std::array<std::atomic<Word>, WORDS> words;
+    };
+
+}
@@ -22,6 +22,7 @@
 #include <arpirobot/core/device/BaseDevice.hpp>
 #include <arpirobot/core/drive/BaseAxisTransform.hpp>
 #include <arpirobot/core/action/BaseActionTrigger.hpp>
+#include <arpirobot/core/network/ControllerData.hpp>
 
 #include <unordered_map>
 
@@ -69,6 +70,13 @@ namespace arpirobot{
          */
         int getDpad(int dpadNum);
 
+        /**
+         * Get packet loss, jitter, and delay statistics for this controller's data.
+         * Only tracked if the drive station sends extended controller packets.
+         * @return The statistics (all zero if no data has been received for this controller)
+         */
+        ControllerLinkStats getLinkStats();
+
         /**
          * Set the axis transform for a given axis
          * @param axisNum The axis number to apply a transform to. Referenced object must remain in scope until cleared.
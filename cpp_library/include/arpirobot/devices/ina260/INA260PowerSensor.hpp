@@ -157,6 +157,13 @@ namespace arpirobot{
          */
         double getPower();
 
+        /**
+         * Add this power sensor as a telemetry source (fields: current, voltage, power)
+         * The source is removed when this object is destroyed (or if this is called again).
+         * @return The ID of the source (-1 if the source could not be added)
+         */
+        int addTelemetrySource();
+
     protected:
         void begin() override;
 
@@ -181,6 +188,9 @@ namespace arpirobot{
         bool stop = false;
 
         int bus;
+
+        // Telemetry source sampling this object (-1 if none)
+        int telemetrySourceId = -1;
     };
 
 }
\ No newline at end of file
@@ -48,24 +48,15 @@ void ArduinoDevice::setDeviceId(int deviceId){
     this->deviceId = deviceId;
 }
 
+ByteView ArduinoDevice::payloadOf(ByteView data){
+    return data.subview(1);
+}
+
 bool ArduinoDevice::sendData(const std::vector<uint8_t> &data){
-    if(arduino == nullptr)
+    // Not added to an arduino or not created on the arduino
+    if(arduino == nullptr || deviceId < 0)
         return false;
-    try{
-        // Add '-' to the front to indicate that this data is to be sent to a device
-        // Then add the id of the device
-        std::vector<uint8_t> fullData;
-        fullData.reserve(data.size() + 2);
-        fullData.push_back('-');
-        fullData.push_back((uint8_t)deviceId);
-        for(size_t i = 0; i < data.size(); ++i){
-            fullData.push_back(data[i]);
-        }
-        return true;
-    }catch(std::exception &e){
-        Logger::logDebugFrom(getDeviceName(), e.what());
-        return false;
-    }
+    return arduino->sendFromDevice((uint8_t)deviceId, data);
 }
 
 bool ArduinoDevice::sendData(const std::string &data){
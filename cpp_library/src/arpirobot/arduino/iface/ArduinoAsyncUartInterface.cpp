@@ -0,0 +1,271 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/arduino/iface/ArduinoAsyncUartInterface.hpp>
+#include <arpirobot/arduino/iface/ArduinoReactor.hpp>
+#include <arpirobot/core/io/exceptions.hpp>
+#include <arpirobot/core/log/Logger.hpp>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+
+using namespace arpirobot;
+using namespace std::placeholders;
+
+
+const size_t ArduinoAsyncUartInterface::MAX_PENDING = 4096;
+const size_t ArduinoAsyncUartInterface::MAX_TX_PENDING = 4096;
+
+ArduinoAsyncUartInterface::ArduinoAsyncUartInterface(std::string port, int baud) : port(port), baud(baud){
+
+}
+
+ArduinoAsyncUartInterface::~ArduinoAsyncUartInterface(){
+    // Handlers reference this object. Make sure none are pending.
+    close();
+}
+
+void ArduinoAsyncUartInterface::open(){
+    if(serialPort != nullptr){
+        // Reopening after a read failed
+        close();
+    }
+
+    asio::io_service &reactor = ArduinoReactor::acquire();
+    serialPort.reset(new asio::serial_port(reactor));
+    std::error_code ec;
+    serialPort->open(port, ec);
+    if(!ec) serialPort->set_option(asio::serial_port_base::baud_rate(baud), ec);
+    if(!ec) serialPort->set_option(asio::serial_port_base::character_size(8), ec);
+    if(!ec) serialPort->set_option(asio::serial_port_base::parity(asio::serial_port_base::parity::none), ec);
+    if(!ec) serialPort->set_option(asio::serial_port_base::stop_bits(asio::serial_port_base::stop_bits::one), ec);
+    if(!ec) serialPort->set_option(asio::serial_port_base::flow_control(asio::serial_port_base::flow_control::none), ec);
+    if(ec){
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), ec.message());
+        serialPort.reset();
+        ArduinoReactor::release();
+        throw OpenFailedException();
+    }
+
+    {
+        std::lock_guard<std::mutex> l(lock);
+        rxPending.clear();
+        txPending.clear();
+        failed = false;
+        reading = true;
+        io = &reactor;
+    }
+    sendPosted = false;
+    ArduinoReactor::runAndWait(std::bind(&ArduinoAsyncUartInterface::startRead, this));
+}
+
+void ArduinoAsyncUartInterface::close(){
+    if(serialPort == nullptr)
+        return;
+
+    // No more sends are posted
+    {
+        std::lock_guard<std::mutex> l(lock);
+        io = nullptr;
+    }
+
+    // Closing cancels the read and write in progress. Their handlers still run (on the reactor thread).
+    ArduinoReactor::runAndWait([this](){
+        processing = false;
+        std::error_code ec;
+        serialPort->close(ec);
+    });
+    {
+        std::unique_lock<std::mutex> l(lock);
+        cv.wait(l, [this](){ return !reading && !writing && postedSends == 0; });
+    }
+
+    serialPort.reset();
+    ArduinoReactor::release();
+}
+
+bool ArduinoAsyncUartInterface::isOpen(){
+    if(serialPort == nullptr)
+        return false;
+    std::lock_guard<std::mutex> l(lock);
+    return !failed;
+}
+
+int ArduinoAsyncUartInterface::available(){
+    std::lock_guard<std::mutex> l(lock);
+    return rxPending.size();
+}
+
+size_t ArduinoAsyncUartInterface::readChunk(uint8_t *buf, size_t count, int timeoutMs){
+    std::unique_lock<std::mutex> l(lock);
+    cv.wait_for(l, std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0),
+        [this](){ return !rxPending.empty() || !reading; });
+    if(rxPending.empty()){
+        if(!reading)
+            throw ReadFailedException();
+        return 0;
+    }
+    size_t n = std::min(count, rxPending.size());
+    std::copy(rxPending.begin(), rxPending.begin() + n, buf);
+    rxPending.erase(rxPending.begin(), rxPending.begin() + n);
+    return n;
+}
+
+void ArduinoAsyncUartInterface::write(const uint8_t *data, size_t len){
+    // Data is queued and written by the reactor thread. Never waits for the port.
+    std::lock_guard<std::mutex> l(lock);
+    if(io == nullptr || !reading || failed)
+        throw WriteFailedException();
+    if(txPending.size() + len > MAX_TX_PENDING){
+        ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), "Too much data waiting to be written.");
+        throw WriteFailedException();
+    }
+    txPending.insert(txPending.end(), data, data + len);
+    if(!writing){
+        writing = true;
+        io->post(std::bind(&ArduinoAsyncUartInterface::startWrite, this));
+    }
+}
+
+std::string ArduinoAsyncUartInterface::getDeviceName(){
+    return "ArduinoAsyncUartInterface(" + port + ", " + std::to_string(baud) + ")";
+}
+
+void ArduinoAsyncUartInterface::startProcessing(){
+    if(serialPort == nullptr)
+        return;
+    ArduinoReactor::runAndWait([this](){
+        // Data received since the last readChunk is handled first
+        std::vector<uint8_t> received;
+        bool stillReading;
+        {
+            std::lock_guard<std::mutex> l(lock);
+            received.swap(rxPending);
+            stillReading = reading;
+        }
+        processing = processReceived(received.data(), received.size());
+        if(processing && !stillReading){
+            processing = false;
+            lostCommunication("Serial port read failed.");
+        }
+    });
+}
+
+void ArduinoAsyncUartInterface::stopProcessing(){
+    if(serialPort == nullptr)
+        return;
+    ArduinoReactor::runAndWait([this](){
+        processing = false;
+    });
+}
+
+void ArduinoAsyncUartInterface::requestSend(){
+    // Messages queued before the posted send starts are sent by it
+    if(sendPosted.exchange(true))
+        return;
+    std::lock_guard<std::mutex> l(lock);
+    if(io == nullptr){
+        sendPosted = false;
+        return;
+    }
+    postedSends++;
+    io->post([this](){
+        sendPosted = false;
+        sendQueued();
+
+        // close may destroy this object as soon as no sends are posted. Nothing is used after unlocking.
+        std::lock_guard<std::mutex> l(lock);
+        postedSends--;
+        cv.notify_all();
+    });
+}
+
+void ArduinoAsyncUartInterface::startRead(){
+    serialPort->async_read_some(asio::buffer(readBuffer),
+        std::bind(&ArduinoAsyncUartInterface::handleRead, this, _1, _2));
+}
+
+void ArduinoAsyncUartInterface::handleRead(const std::error_code &ec, size_t count){
+    if(ec){
+        bool aborted = (ec == asio::error::operation_aborted);
+        if(processing && !aborted){
+            processing = false;
+            lostCommunication(ec.message());
+        }
+
+        // close may destroy this object as soon as it sees reading is false. Nothing is used after unlocking.
+        std::lock_guard<std::mutex> l(lock);
+        reading = false;
+        failed = failed || !aborted;
+        cv.notify_all();
+        return;
+    }
+
+    if(processing){
+        if(!processReceived(readBuffer.data(), count))
+            processing = false;
+    }else{
+        {
+            std::lock_guard<std::mutex> l(lock);
+            rxPending.insert(rxPending.end(), readBuffer.begin(), readBuffer.begin() + count);
+            if(rxPending.size() > MAX_PENDING)
+                rxPending.erase(rxPending.begin(), rxPending.end() - MAX_PENDING);
+        }
+        cv.notify_all();
+    }
+    startRead();
+}
+
+void ArduinoAsyncUartInterface::startWrite(){
+    {
+        std::lock_guard<std::mutex> l(lock);
+        if(txPending.empty()){
+            // close may destroy this object as soon as it sees writing is false. Nothing is used after unlocking.
+            writing = false;
+            cv.notify_all();
+            return;
+        }
+        txWriting.swap(txPending);
+        txPending.clear();
+    }
+    asio::async_write(*serialPort, asio::buffer(txWriting),
+        std::bind(&ArduinoAsyncUartInterface::handleWrite, this, _1, _2));
+}
+
+void ArduinoAsyncUartInterface::handleWrite(const std::error_code &ec, size_t /*count*/){
+    txWriting.clear();
+    if(ec){
+        bool aborted = (ec == asio::error::operation_aborted);
+        if(processing && !aborted){
+            processing = false;
+            lostCommunication(ec.message());
+        }
+
+        // close may destroy this object as soon as it sees writing is false. Nothing is used after unlocking.
+        std::lock_guard<std::mutex> l(lock);
+        txPending.clear();
+        writing = false;
+        failed = failed || !aborted;
+        cv.notify_all();
+        return;
+    }
+
+    // Write anything queued while this write was in progress
+    startWrite();
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/arduino/iface/ArduinoReactor.hpp>
+#include <arpirobot/core/log/Logger.hpp>
+#include <future>
+#include <exception>
+
+using namespace arpirobot;
+
+
+asio::io_service ArduinoReactor::io;
+std::unique_ptr<asio::io_service::work> ArduinoReactor::wk;
+std::thread *ArduinoReactor::reactorThread = nullptr;
+std::mutex ArduinoReactor::lock;
+int ArduinoReactor::users = 0;
+
+asio::io_service &ArduinoReactor::acquire(){
+    std::lock_guard<std::mutex> l(lock);
+    if(users++ == 0){
+        // run returned when the previous thread was stopped
+        io.restart();
+        wk.reset(new asio::io_service::work(io));
+        reactorThread = new std::thread(&ArduinoReactor::run);
+    }
+    return io;
+}
+
+void ArduinoReactor::release(){
+    std::lock_guard<std::mutex> l(lock);
+    if(users == 0 || --users > 0)
+        return;
+    // Without work run returns once all pending handlers have run (none are left for the next acquire)
+    wk.reset();
+    reactorThread->join();
+    delete reactorThread;
+    reactorThread = nullptr;
+}
+
+void ArduinoReactor::runAndWait(const std::function<void()> &func){
+    if(io.get_executor().running_in_this_thread()){
+        func();
+        return;
+    }
+    std::promise<void> done;
+    io.post([&func, &done](){
+        try{
+            func();
+            done.set_value();
+        }catch(...){
+            done.set_exception(std::current_exception());
+        }
+    });
+    done.get_future().get();
+}
+
+void ArduinoReactor::run(){
+    while(true){
+        try{
+            io.run();
+            return;
+        }catch(const std::exception &e){
+            // Handlers should not throw. Keep handling the other interfaces' data.
+            ARPIROBOT_LOG_DEBUG_FROM("ArduinoReactor", e.what());
+        }
+    }
+}
@@ -35,6 +35,9 @@ ArduinoUartInterface::ArduinoUartInterface(std::string port, int baud) :
 }
 
 ArduinoUartInterface::~ArduinoUartInterface(){
+    // The processing thread uses readChunk
+    stopProcessing();
+    close();
     delete portCStr;
 }
 
@@ -45,8 +48,10 @@ void ArduinoUartInterface::open() {
 }
 
 void ArduinoUartInterface::close() {
-    if(isOpen())
+    if(isOpen()){
         Io::uartClose(handle);
+        handle = -1;
+    }
 }
 
 bool ArduinoUartInterface::isOpen() {
@@ -62,34 +67,16 @@ int ArduinoUartInterface::available() {
     return Io::uartAvailable(handle);
 }
 
-uint8_t ArduinoUartInterface::readOne() {
-    if(handle < 0){
-        auto msg = "Invalid UART handle in ArduinoUART interface.";
-        Logger::logErrorFrom(getDeviceName(), msg);
-        throw std::runtime_error(msg);
-    }
-    while(!available()){
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
-    }
-    return Io::uartReadByte(handle);
-}
-
-std::vector<uint8_t> ArduinoUartInterface::readAll() {
+size_t ArduinoUartInterface::readChunk(uint8_t *buf, size_t count, int timeoutMs) {
     if(handle < 0){
         auto msg = "Invalid UART handle in ArduinoUART interface.";
         Logger::logErrorFrom(getDeviceName(), msg);
         throw std::runtime_error(msg);
     }
-    int a = available();
-	std::vector<uint8_t> data;
-    data.reserve(a);
-    for(int i = 0; i < a; ++i){
-        data.push_back(readOne());
-    }
-    return data;
+    return Io::uartReadTimeout(handle, reinterpret_cast<char*>(buf), count, timeoutMs > 0 ? timeoutMs : 0);
 }
 
-void ArduinoUartInterface::write(const uint8_t &b) {
+void ArduinoUartInterface::write(const uint8_t *data, size_t len) {
     if(handle < 0){
         auto msg = "Invalid UART handle in ArduinoUART interface.";
         Logger::logErrorFrom(getDeviceName(), msg);
@@ -97,10 +84,12 @@ void ArduinoUartInterface::write(const uint8_t &b) {
     }
 
     // Some boards, cables, power supplies, etc may cause scenarios where writes fail.
-    // Allow three retries
+    // Allow three retries. The whole frame is resent. If part of it was sent the arduino
+    // discards the partial frame when it receives the next start byte.
+    Io::UartBuffer buf = {reinterpret_cast<const char*>(data), (unsigned int)len};
     for(uint8_t i = 0; i < 3; ++i){
         try{
-            Io::uartWriteByte(handle, b);
+            Io::uartWritev(handle, &buf, 1);
             break;
         }catch(const WriteFailedException &e){
             if(i == 2)
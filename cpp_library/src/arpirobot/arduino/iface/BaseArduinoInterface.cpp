@@ -21,6 +21,7 @@
 #include <arpirobot/arduino/device/ArduinoDevice.hpp>
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/robot/BaseRobot.hpp>
+#include <arpirobot/core/util/Crc16.hpp>
 #include <functional>
 #include <algorithm>
 #include <cstring>
@@ -32,18 +33,24 @@ const uint8_t BaseArduinoInterface::START_BYTE = 253;
 const uint8_t BaseArduinoInterface::END_BYTE = 254;
 const uint8_t BaseArduinoInterface::ESCAPE_BYTE = 255;
 
+const uint8_t BaseArduinoInterface::AGGREGATE_ID = 255;
+
+const int BaseArduinoInterface::RUN_READ_TIMEOUT_MS = 100;
+const size_t BaseArduinoInterface::MAX_QUEUED_MESSAGES = 64;
+const int BaseArduinoInterface::AGGREGATE_REPLY_TIMEOUT_MS = 500;
+
 const std::vector<uint8_t> BaseArduinoInterface::MSG_START = {'S', 'T', 'A', 'R', 'T'};
 const std::vector<uint8_t> BaseArduinoInterface::MSG_ADD = {'A', 'D', 'D'};
 const std::vector<uint8_t> BaseArduinoInterface::MSG_ADDSUCCESS = {'A', 'D', 'D', 'S', 'U', 'C', 'C', 'E', 'S', 'S'};
 
 const std::vector<uint8_t> BaseArduinoInterface::CMD_RESET = {'R', 'E', 'S', 'E', 'T'};
 const std::vector<uint8_t> BaseArduinoInterface::CMD_END = {'E', 'N', 'D'};
+const std::vector<uint8_t> BaseArduinoInterface::CMD_AGGREGATE = {'A', 'G', 'G'};
 
 BaseArduinoInterface::~BaseArduinoInterface(){
-    if(processThread != nullptr){
-        processThread->join();
-        delete processThread;
-    }
+    // Calls the base class stopProcessing (derived classes are already destroyed).
+    // Interfaces stop processing in their own destructor, while readChunk can still be called.
+    stopProcessing();
 
     for(auto &dev : devices){
         dev->setArduino(nullptr);
@@ -52,6 +59,14 @@ BaseArduinoInterface::~BaseArduinoInterface(){
 
 bool BaseArduinoInterface::begin(){
     initialized = true;
+
+    // Configuring reads from the interface directly. Make sure nothing else is.
+    arduinoReady = false;
+    stopProcessing();
+
+    // Devices are returned to their default state while configuring. Older messages no longer apply.
+    dropQueued();
+
     parseStarted = false;
     parseEscaped = false;
 
@@ -60,7 +75,7 @@ bool BaseArduinoInterface::begin(){
             open();
     }catch(const std::exception &e){
         Logger::logErrorFrom(getDeviceName(), "Unable to open arduino interface.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
         return false;
     }
     
@@ -69,7 +84,7 @@ bool BaseArduinoInterface::begin(){
         return false;
     }
 
-    Logger::logDebugFrom(getDeviceName(), "Opened interface.");
+    ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), "Opened interface.");
 
     try{
         // Clear any start message from the buffer
@@ -89,11 +104,11 @@ bool BaseArduinoInterface::begin(){
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }catch(const std::exception &e){
         Logger::logWarningFrom(getDeviceName(), "Error while configuring devices.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
         return false;
     }
 
-    Logger::logDebugFrom(getDeviceName(), "Arduino is ready. Creating devices.");
+    ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), "Arduino is ready. Creating devices.");
 
     try{
         for(auto dev : devices){
@@ -111,7 +126,7 @@ bool BaseArduinoInterface::begin(){
                     }else if(msgStartsWith(msg, MSG_ADDSUCCESS)){
                         dev->setDeviceId(msg[10]);
                         dev->applyDefaultState();
-                        Logger::logDebugFrom(dev->getDeviceName(), "Created device with ID " + std::to_string(dev->deviceId));
+                        ARPIROBOT_LOG_DEBUG_FROM(dev->getDeviceName(), "Created device with ID " + std::to_string(dev->deviceId));
                     }else{
                         Logger::logWarningFrom(getDeviceName(), "Arduino failed to add device " + dev->getDeviceName());
                         dev->setDeviceId(-1);
@@ -121,11 +136,21 @@ bool BaseArduinoInterface::begin(){
         }
     }catch(const std::exception &e){
         Logger::logWarningFrom(getDeviceName(), "Error while configuring devices.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
+        return false;
+    }
+
+    try{
+        aggregating = negotiateAggregate();
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), aggregating ? 
+            "Arduino will send aggregated frames." : "Arduino will send a frame per device.");
+    }catch(const std::exception &e){
+        Logger::logWarningFrom(getDeviceName(), "Error while configuring devices.");
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
         return false;
     }
 
-    Logger::logDebugFrom(getDeviceName(), "Done creating devices. Starting sensor processing.");
+    ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), "Done creating devices. Starting sensor processing.");
 
     try{
         writeData(CMD_END);
@@ -136,19 +161,22 @@ bool BaseArduinoInterface::begin(){
         }
     }catch(const std::exception &e){
         Logger::logWarningFrom(getDeviceName(), "Error while configuring devices.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
         return false;
     }
 
-    Logger::logDebugFrom(getDeviceName(), "Sensor processing started successfully.");
+    ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), "Sensor processing started successfully.");
 
-    if(processThread != nullptr){
-        arduinoReady = false;
-        processThread->join();
-        delete processThread;
+    devicesById.fill(nullptr);
+    for(auto &dev : devices){
+        if(dev->deviceId >= 0 && dev->deviceId < AGGREGATE_ID)
+            devicesById[dev->deviceId] = dev.get();
     }
     arduinoReady = true;
-    processThread = new std::thread(std::bind(&BaseArduinoInterface::run, this));
+    startProcessing();
+
+    // Send messages queued while configuring (default states)
+    requestSend();
     return true;
 }
 
@@ -176,93 +204,288 @@ bool BaseArduinoInterface::isReady(){
     return arduinoReady;
 }
 
-void BaseArduinoInterface::sendFromDevice(uint8_t deviceId, std::vector<uint8_t> data){
+bool BaseArduinoInterface::isAggregating(){
+    return aggregating;
+}
+
+bool BaseArduinoInterface::sendFromDevice(uint8_t deviceId, ByteView data){
+    uint8_t type = data.empty() ? 0 : data[0];
+    {
+        std::lock_guard<std::mutex> l(sendLock);
+        QueuedMessage *msg = nullptr;
+        for(auto &queued : sendQueue){
+            if(queued.deviceId == deviceId && (queued.data.empty() ? 0 : queued.data[0]) == type){
+                // Replace the older message, keeping its place in the queue
+                msg = &queued;
+                sendStats.coalescedCommands++;
+                break;
+            }
+        }
+        if(msg == nullptr){
+            if(sendQueue.size() >= MAX_QUEUED_MESSAGES){
+                sendStats.droppedCommands++;
+                ARPIROBOT_LOG_WARNING_FROM_LIMITED(getDeviceName(), 
+                    "Too many messages waiting to be sent. Dropped message to device with ID " + std::to_string(deviceId) + ".");
+                return false;
+            }
+            sendQueue.emplace_back();
+            msg = &sendQueue.back();
+            msg->deviceId = deviceId;
+            sendStats.queuedCommands = sendQueue.size();
+            sendStats.peakQueuedCommands = std::max(sendStats.peakQueuedCommands, sendQueue.size());
+        }
+        msg->data.assign(data.begin(), data.end());
+        msg->queueTime = std::chrono::steady_clock::now();
+    }
+    requestSend();
+    return true;
+}
+
+ArduinoSendStats BaseArduinoInterface::getSendStats(){
+    std::lock_guard<std::mutex> l(sendLock);
+    return sendStats;
+}
+
+const LatencyHistogram &BaseArduinoInterface::getSendLatency() const{
+    return sendLatency;
+}
+
+void BaseArduinoInterface::requestSend(){
+    {
+        std::lock_guard<std::mutex> l(sendWakeLock);
+        sendRequested = true;
+    }
+    sendWake.notify_one();
+}
+
+void BaseArduinoInterface::sendQueued(){
+    // Never waits for writeLock. begin holds it for each configuration write and must not delay (or wait for)
+    // the thread sending. If another thread holds it, that thread sends these messages once it is done.
+    // Messages are sent once ready (begin calls requestSend).
+    while(arduinoReady){
+        sendPending = true;
+        std::unique_lock<std::mutex> w(writeLock, std::try_to_lock);
+        if(!w.owns_lock())
+            return;
+        sendPending = false;
+        if(arduinoReady)
+            writeQueued();
+        w.unlock();
+
+        // Messages may have been queued while writing
+        if(!sendPending)
+            return;
+    }
+}
+
+void BaseArduinoInterface::writeQueued(){
+    {
+        std::lock_guard<std::mutex> l(sendLock);
+        sending.swap(sendQueue);
+        sendStats.queuedCommands = 0;
+    }
+    if(sending.empty())
+        return;
+
+    // All queued messages are written with one call to write
+    // '-' indicates that the data is to be sent to a device, followed by the id of the device
+    txBuffer.clear();
+    for(auto &msg : sending){
+        const uint8_t header[2] = {'-', msg.deviceId};
+        appendFrame(ByteView(header, 2), msg.data);
+    }
+
+    bool sent = false;
     try{
-        std::vector<uint8_t> sendData;
-        sendData.reserve(data.size() + 2);
-        sendData.push_back('-');
-        sendData.push_back(deviceId);
-        sendData.insert(sendData.end(), data.begin(), data.end());
-        writeData(sendData);
+        write(txBuffer.data(), txBuffer.size());
+        sent = true;
     }catch(std::exception &e){
-        Logger::logWarningFrom(getDeviceName(), "Failed to send message to device with ID " + std::to_string(deviceId) + ".");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_WARNING_FROM_LIMITED(getDeviceName(), 
+            "Failed to send " + std::to_string(sending.size()) + " message(s) to devices.");
+        ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), e.what());
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if(sent){
+        for(auto &msg : sending)
+            sendLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - msg.queueTime).count());
+    }
+    {
+        std::lock_guard<std::mutex> l(sendLock);
+        if(sent)
+            sendStats.sentCommands += sending.size();
+        else
+            sendStats.droppedCommands += sending.size();
+    }
+    sending.clear();
+}
+
+void BaseArduinoInterface::dropQueued(){
+    std::lock_guard<std::mutex> l(sendLock);
+    sendStats.droppedCommands += sendQueue.size();
+    sendStats.queuedCommands = 0;
+    sendQueue.clear();
+}
+
+void BaseArduinoInterface::startProcessing(){
+    processThread = new std::thread(std::bind(&BaseArduinoInterface::run, this));
+    sendThread = new std::thread(std::bind(&BaseArduinoInterface::sendLoop, this));
+}
+
+void BaseArduinoInterface::stopProcessing(){
+    // Processing thread checks arduinoReady at least every RUN_READ_TIMEOUT_MS
+    arduinoReady = false;
+    if(processThread != nullptr){
+        processThread->join();
+        delete processThread;
+        processThread = nullptr;
+    }
+
+    // Send thread checks arduinoReady when woken. Locking makes sure it is not about to wait.
+    {
+        std::lock_guard<std::mutex> l(sendWakeLock);
+    }
+    sendWake.notify_all();
+    if(sendThread != nullptr){
+        sendThread->join();
+        delete sendThread;
+        sendThread = nullptr;
     }
 }
 
 void BaseArduinoInterface::run(){
     while(arduinoReady){
         try{
-            if(readData() && checkData()){
-                // Special case check
-                if(msgEquals(readDataset, MSG_START)){
-                    Logger::logWarningFrom(getDeviceName(), "Arduino was reset while running. Sensor data is now INVALID! Will reconfigure.");
-                    break;
-                }
-
-                int deviceId = readDataset[0];
-                for(auto dev : devices){
-                    if(dev->deviceId == deviceId){
-                        dev->handleData(readDataset);
-                        break;
-                    }
-                }
-            }
+            if(readData(RUN_READ_TIMEOUT_MS) && !handleFrame())
+                return;
         }catch(const std::exception &e){
-            Logger::logWarningFrom(getDeviceName(), "Lost communication with the arduino. Sensor data is now INVALID!. Will reconfigure.");
-            Logger::logDebugFrom(getDeviceName(), e.what());
-            arduinoReady = false;
+            lostCommunication(e.what());
+            return;
+        }
+    }
+}
+
+void BaseArduinoInterface::sendLoop(){
+    std::unique_lock<std::mutex> l(sendWakeLock);
+    while(true){
+        sendWake.wait(l, [this](){ return sendRequested || !arduinoReady; });
+        if(!arduinoReady)
+            return;
+        sendRequested = false;
+        l.unlock();
+        sendQueued();
+        l.lock();
+    }
+}
+
+bool BaseArduinoInterface::processReceived(const uint8_t *data, size_t len){
+    rxTime = std::chrono::steady_clock::now();
+    try{
+        while(rxPos < rxLen){
+            if(parseByte(rxBuffer[rxPos++]) && !handleFrame())
+                return false;
+        }
+        for(size_t i = 0; i < len; ++i){
+            if(parseByte(data[i]) && !handleFrame())
+                return false;
         }
+    }catch(const std::exception &e){
+        lostCommunication(e.what());
+        return false;
     }
+    return true;
+}
+
+void BaseArduinoInterface::lostCommunication(const std::string &details){
+    Logger::logWarningFrom(getDeviceName(), "Lost communication with the arduino. Sensor data is now INVALID!. Will reconfigure.");
+    ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), details);
+    arduinoReady = false;
 
-    // The above loop exits when communication is lost
     // Have begin run asynchronously
     BaseRobot::runOnceSoon(std::bind(&BaseArduinoInterface::begin, this));
 }
 
+bool BaseArduinoInterface::handleFrame(){
+    if(!checkData())
+        return true;
+
+    // Special case check
+    if(msgEquals(readDataset, MSG_START)){
+        Logger::logWarningFrom(getDeviceName(), "Arduino was reset while running. Sensor data is now INVALID! Will reconfigure.");
+        arduinoReady = false;
+        BaseRobot::runOnceSoon(std::bind(&BaseArduinoInterface::begin, this));
+        return false;
+    }
+
+    // Devices are not given the CRC (see ArduinoDevice::handleData)
+    ByteView frame = ByteView(readDataset).subview(0, readDataset.size() - 2);
+    if(frame[0] == AGGREGATE_ID){
+        dispatchAggregate(frame);
+    }else{
+        dispatch(frame);
+    }
+    return true;
+}
+
 uint16_t BaseArduinoInterface::calcCCittFalse(const std::vector<uint8_t> &data, size_t len){
-    uint16_t crc = 0xFFFF;
-    int pos = 0;
-    while(pos < len){
-        uint8_t b = data[pos];
-        for(int i = 0; i < 8; ++i){
-            uint8_t bit = ((b >> (7 - i) & 1) == 1);
-            uint8_t c15 = ((crc >> 15 & 1) == 1);
-            crc <<= 1;
-            if(c15 ^ bit){
-                crc ^= 0x1021;
-            }
-        }
-        pos++;
+    return Crc16::ccittFalse(data.data(), len);
+}
+
+void BaseArduinoInterface::writeData(ByteView data){
+    writeFrame(ByteView(), data);
+}
+
+void BaseArduinoInterface::writeFrame(ByteView header, ByteView data){
+    {
+        std::lock_guard<std::mutex> l(writeLock);
+        txBuffer.clear();
+        appendFrame(header, data);
+        write(txBuffer.data(), txBuffer.size());
     }
-    return crc;
+
+    // Messages from devices that were not sent while this held writeLock
+    if(sendPending && arduinoReady)
+        requestSend();
+}
+
+void BaseArduinoInterface::appendFrame(ByteView header, ByteView data){
+    // Worst case every byte (including CRC) is escaped
+    txBuffer.reserve(txBuffer.size() + 2 * (header.size() + data.size() + 2) + 2);
+
+    txBuffer.push_back(START_BYTE);
+    appendEscaped(header);
+    appendEscaped(data);
+
+    // Calculate CRC (of the header followed by the data)
+    uint16_t crc = Crc16::ccittFalse(data.data(), data.size(), Crc16::ccittFalse(header.data(), header.size()));
+    const uint8_t crcBytes[2] = {(uint8_t)(crc >> 8), (uint8_t)crc};
+    appendEscaped(ByteView(crcBytes, 2));
+
+    txBuffer.push_back(END_BYTE);
 }
 
-void BaseArduinoInterface::writeData(const std::vector<uint8_t> &data){
-    write(START_BYTE);
-    for(int i = 0; i < data.size(); ++i){
-        const uint8_t &b = data[i];
+void BaseArduinoInterface::appendEscaped(ByteView data){
+    for(uint8_t b : data){
         if(b == START_BYTE || b == END_BYTE || b == ESCAPE_BYTE)
-            write(ESCAPE_BYTE);
-        write(b);
+            txBuffer.push_back(ESCAPE_BYTE);
+        txBuffer.push_back(b);
     }
+}
 
-    // Calculate CRC
-    uint16_t crc = calcCCittFalse(data, data.size());
-    const uint8_t crc_low = crc & 0x00FF;
-    const uint8_t crc_high = crc >> 8 & 0x00FF;
-    if(crc_high == START_BYTE || crc_high == END_BYTE || crc_high == ESCAPE_BYTE)
-        write(ESCAPE_BYTE);
-    write(crc_high);
-    if(crc_low == START_BYTE || crc_low == END_BYTE || crc_low == ESCAPE_BYTE)
-        write(ESCAPE_BYTE);
-    write(crc_low);
-
-    write(END_BYTE);
+bool BaseArduinoInterface::readData(int timeoutMs){
+    if(rxPos == rxLen){
+        rxPos = 0;
+        rxLen = readChunk(rxBuffer.data(), rxBuffer.size(), timeoutMs);
+        rxTime = std::chrono::steady_clock::now();
+    }
+    while(rxPos < rxLen){
+        if(parseByte(rxBuffer[rxPos++]))
+            return true;
+    }
+    return false;
 }
 
-bool BaseArduinoInterface::readData(){
-    uint8_t b = readOne();
+bool BaseArduinoInterface::parseByte(uint8_t b){
     if(parseEscaped){
         // Only allow valid escape sequences
         if(b == START_BYTE || b == END_BYTE || b == ESCAPE_BYTE)
@@ -276,10 +499,9 @@ bool BaseArduinoInterface::readData(){
             }
             parseStarted = true;
         }else if(b == END_BYTE && parseStarted){
-            readDataset.clear();
-            for(size_t i = 0; i < workingBuffer.size(); ++i){
-                readDataset.push_back(workingBuffer[i]);
-            }
+            // Swap so neither buffer is copied or reallocated
+            readDataset.swap(workingBuffer);
+            readDatasetTime = rxTime;
             workingBuffer.clear();
             parseStarted = false;
             return true;
@@ -294,30 +516,59 @@ bool BaseArduinoInterface::readData(){
 
 bool BaseArduinoInterface::checkData(){
 
-    if(readDataset.size() == 0)
+    // Need at least a device ID (or command) and the CRC
+    if(readDataset.size() < 3)
         return false;
     // CRC is sent big endian (high_byte, low_byte)
     uint16_t readCrc = readDataset[readDataset.size() - 2] << 8 | readDataset[readDataset.size() - 1];
     uint16_t calcCrc = calcCCittFalse(readDataset, readDataset.size() - 2);
 
     if(readCrc != calcCrc){
-        Logger::logDebugFrom(getDeviceName(), "CRC check failed for a message.");
+        ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), "CRC check failed for a message.");
     }
     return readCrc == calcCrc;
 }
 
+void BaseArduinoInterface::dispatch(ByteView data){
+    ArduinoDevice *dev = devicesById[data[0]];
+    if(dev != nullptr){
+        dev->receiveTime = readDatasetTime;
+        dev->handleData(data);
+    }
+}
+
+void BaseArduinoInterface::dispatchAggregate(ByteView frame){
+    // frame = AGGREGATE_ID, count, then count entries of: length, deviceId, data... (length bytes of data)
+    if(frame.size() < 2)
+        return;
+    size_t count = frame[1];
+    size_t pos = 2;
+    for(size_t i = 0; i < count; ++i){
+        if(frame.size() - pos < 2 || frame.size() - pos - 2 < frame[pos]){
+            ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), "Malformed aggregated frame.");
+            return;
+        }
+        size_t len = frame[pos];
+        dispatch(frame.subview(pos + 1, len + 1));
+        pos += len + 2;
+    }
+}
+
+bool BaseArduinoInterface::negotiateAggregate(){
+    writeData(CMD_AGGREGATE);
+    auto msg = waitForMessage(CMD_AGGREGATE, AGGREGATE_REPLY_TIMEOUT_MS);
+    return msg.size() > 0;
+}
+
 std::vector<uint8_t> BaseArduinoInterface::waitForMessage(const std::vector<uint8_t> &prefix, int timeoutMs){
     auto start = std::chrono::steady_clock::now();
     while(true){
-        while(available()  == 0){
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - start).count();
-            if(elapsed >= timeoutMs){
-                return {};
-            }
+        int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if(elapsed >= timeoutMs){
+            return {};
         }
-        if(readData() && checkData()){
+        if(readData(timeoutMs - elapsed) && checkData()){
             if(msgStartsWith(readDataset, prefix)){
                 return readDataset;
             }
@@ -19,7 +19,7 @@
 
 #include <arpirobot/arduino/sensor/IRReflectorModule.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/core/util/Endian.hpp>
 
 using namespace arpirobot;
 
@@ -61,16 +61,23 @@ IRReflectorModule::IRReflectorModule(std::string digitalPin, std::string analogP
 }
 
 bool IRReflectorModule::getDigitalValue(){
-    return digitalValue;
+    return state.load().digitalValue;
 }
 
 int IRReflectorModule::getAnalogValue(){
-    return analogValue;
+    return state.load().analogValue;
+}
+
+IRReflectorModule::Reading IRReflectorModule::snapshot() const{
+    return state.load();
+}
+
+const IRReflectorModule::History &IRReflectorModule::getHistory() const{
+    return history;
 }
 
 void IRReflectorModule::applyDefaultState(){
-    digitalValue = false;
-    analogValue = 0;
+    state.store(Reading{false, 0});
 }
 
 std::vector<uint8_t> IRReflectorModule::getCreateData(){
@@ -109,14 +116,21 @@ std::vector<uint8_t> IRReflectorModule::getCreateData(){
     return data;
 }
 
-void IRReflectorModule::handleData(const std::vector<uint8_t> &data){
-    // data = deviceId, data..., crc, crc
-    if(data.size() >= 6){
+void IRReflectorModule::handleData(ByteView data){
+    // data = deviceId, data...
+    // data... = digital value, analog value (int16, if an analog pin is used), arduino time (if sent by firmware)
+    ByteView payload = payloadOf(data);
+    Reading reading = state.load();
+    if(payload.size() == 3 || payload.size() >= 7){
         // Has digital and analog values
-        digitalValue = data[1];
-        analogValue = Conversions::convertDataToInt16(data, 2, true);
-    }else if(data.size() >= 4){
+        reading.digitalValue = payload[0];
+        reading.analogValue = Endian::readLittle<int16_t>(&payload[1]);
+        state.store(reading);
+        recordSample(history, reading, payload, 3);
+    }else if(payload.size() >= 1){
         // Has only digital value
-        digitalValue = data[1];
+        reading.digitalValue = payload[0];
+        state.store(reading);
+        recordSample(history, reading, payload, 1);
     }
 }
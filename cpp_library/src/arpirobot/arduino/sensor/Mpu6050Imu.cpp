@@ -19,71 +19,95 @@
 
 #include <arpirobot/arduino/sensor/Mpu6050Imu.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/core/network/Telemetry.hpp>
+#include <arpirobot/arduino/sensor/SensorFrames.hpp>
 
 using namespace arpirobot;
+using namespace arpirobot::internal;
 
 
 Mpu6050Imu::Mpu6050Imu(bool createDevice, int deviceId) : ArduinoDevice(createDevice, deviceId){
     deviceName = "Mpu6050Imu";
 }
 
+Mpu6050Imu::~Mpu6050Imu(){
+    Telemetry::removeSource(telemetrySourceId);
+}
+
 void Mpu6050Imu::calibrate(uint16_t samples){
     if(arduino == nullptr)
         return;
     Logger::logInfoFrom(getDeviceName(), "Starting calibration. Will not get data until calibration is complete.");
-    std::vector<uint8_t> msg;
-    msg.reserve(3);
-    msg.push_back('C'); // Calibrate command
-    auto s = Conversions::convertInt16ToData(samples, true);
-    msg.insert(msg.end(), s.begin(), s.end());
-    // msg = 'C', samples_little_endian
-    arduino->sendFromDevice(this->deviceId, msg);
+    // msg = 'C' (calibrate command), samples_little_endian
+    uint8_t msg[3] = {'C'};
+    Endian::writeLittle(&msg[1], samples);
+    arduino->sendFromDevice(this->deviceId, ByteView(msg, sizeof(msg)));
 }
 
 double Mpu6050Imu::getGyroX(){
-    return gyroX + gyroXOffset;
+    return state.load().gyroX + gyroXOffset;
 }
 
 double Mpu6050Imu::getGyroY(){
-    return gyroY + gyroYOffset;
+    return state.load().gyroY + gyroYOffset;
 }
 
 double Mpu6050Imu::getGyroZ(){
-    return gyroZ + gyroZOffset;
+    return state.load().gyroZ + gyroZOffset;
 }
 
 double Mpu6050Imu::getAccelX(){
-    return accelX;
+    return state.load().accelX;
 }
 
 double Mpu6050Imu::getAccelY(){
-    return accelY;
+    return state.load().accelY;
 }
 
 double Mpu6050Imu::getAccelZ(){
-    return accelZ;
+    return state.load().accelZ;
 }
 
 void Mpu6050Imu::setGyroX(double newGyroX){
-    gyroXOffset = newGyroX - gyroX;
+    gyroXOffset = newGyroX - state.load().gyroX;
 }
 
 void Mpu6050Imu::setGyroY(double newGyroY){
-    gyroYOffset = newGyroY - gyroY;
+    gyroYOffset = newGyroY - state.load().gyroY;
 }
 
 void Mpu6050Imu::setGyroZ(double newGyroZ){
-    gyroZOffset = newGyroZ - gyroZ;
+    gyroZOffset = newGyroZ - state.load().gyroZ;
+}
+
+Mpu6050Imu::Reading Mpu6050Imu::snapshot() const{
+    Reading reading = state.load();
+    reading.gyroX += gyroXOffset;
+    reading.gyroY += gyroYOffset;
+    reading.gyroZ += gyroZOffset;
+    return reading;
+}
+
+const Mpu6050Imu::History &Mpu6050Imu::getHistory() const{
+    return history;
+}
+
+int Mpu6050Imu::addTelemetrySource(){
+    Telemetry::removeSource(telemetrySourceId);
+    telemetrySourceId = Telemetry::addSource(getDeviceName(), {"gyroX", "gyroY", "gyroZ", "accelX", "accelY", "accelZ"}, 
+            [this](float *values){
+        values[0] = getGyroX();
+        values[1] = getGyroY();
+        values[2] = getGyroZ();
+        values[3] = getAccelX();
+        values[4] = getAccelY();
+        values[5] = getAccelZ();
+    });
+    return telemetrySourceId;
 }
 
 void Mpu6050Imu::applyDefaultState(){
-    gyroX = 0;
-    gyroY = 0;
-    gyroZ = 0;
-    accelX = 0;
-    accelY = 0;
-    accelZ = 0;
+    state.store(Reading{0, 0, 0, 0, 0, 0});
 
     gyroXOffset = 0;
     gyroYOffset = 0;
@@ -94,15 +118,12 @@ std::vector<uint8_t> Mpu6050Imu::getCreateData(){
     return stringToData("ADDMPU6050");
 }
 
-void Mpu6050Imu::handleData(const std::vector<uint8_t> &data){
-    // If at least 24 bytes of data (deviceId, data..., crc, crc)
-    if(data.size() >= 27){
-        gyroX = Conversions::convertDataToFloat(data, 1, true);
-        gyroY = Conversions::convertDataToFloat(data, 5, true);
-        gyroZ = Conversions::convertDataToFloat(data, 9, true);
-
-        accelX = Conversions::convertDataToFloat(data, 13, true);
-        accelY = Conversions::convertDataToFloat(data, 17, true);
-        accelZ = Conversions::convertDataToFloat(data, 21, true);
+void Mpu6050Imu::handleData(ByteView data){
+    // data = deviceId, data...
+    ByteView payload = payloadOf(data);
+    ImuFrame frame;
+    if(ImuLayout::decode(payload, frame)){
+        state.store(Reading{frame.gyroX, frame.gyroY, frame.gyroZ, frame.accelX, frame.accelY, frame.accelZ});
+        recordSample(history, snapshot(), payload, ImuLayout::SIZE);
     }
 }
@@ -19,9 +19,10 @@
 
 #include <arpirobot/arduino/sensor/NxpAdafruit9Dof.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/arduino/sensor/SensorFrames.hpp>
 
 using namespace arpirobot;
+using namespace arpirobot::internal;
 
 
 NxpAdafruit9Dof::NxpAdafruit9Dof(bool createDevice, int deviceId) : ArduinoDevice(createDevice, deviceId){
@@ -32,58 +33,62 @@ void NxpAdafruit9Dof::calibrate(uint16_t samples){
     if(arduino == nullptr)
         return;
     Logger::logInfoFrom(getDeviceName(), "Starting calibration. Will not get data until calibration is complete.");
-    std::vector<uint8_t> msg;
-    msg.reserve(3);
-    msg.push_back('C'); // Calibrate command
-    auto s = Conversions::convertInt16ToData(samples, true);
-    msg.insert(msg.end(), s.begin(), s.end());
-    // msg = 'C', samples_little_endian
-    arduino->sendFromDevice(this->deviceId, msg);
+    // msg = 'C' (calibrate command), samples_little_endian
+    uint8_t msg[3] = {'C'};
+    Endian::writeLittle(&msg[1], samples);
+    arduino->sendFromDevice(this->deviceId, ByteView(msg, sizeof(msg)));
 }
 
 double NxpAdafruit9Dof::getGyroX(){
-    return gyroX + gyroXOffset;
+    return state.load().gyroX + gyroXOffset;
 }
 
 double NxpAdafruit9Dof::getGyroY(){
-    return gyroY + gyroYOffset;
+    return state.load().gyroY + gyroYOffset;
 }
 
 double NxpAdafruit9Dof::getGyroZ(){
-    return gyroZ + gyroZOffset;
+    return state.load().gyroZ + gyroZOffset;
 }
 
 double NxpAdafruit9Dof::getAccelX(){
-    return accelX;
+    return state.load().accelX;
 }
 
 double NxpAdafruit9Dof::getAccelY(){
-    return accelY;
+    return state.load().accelY;
 }
 
 double NxpAdafruit9Dof::getAccelZ(){
-    return accelZ;
+    return state.load().accelZ;
 }
 
 void NxpAdafruit9Dof::setGyroX(double newGyroX){
-    gyroXOffset = newGyroX - gyroX;
+    gyroXOffset = newGyroX - state.load().gyroX;
 }
 
 void NxpAdafruit9Dof::setGyroY(double newGyroY){
-    gyroYOffset = newGyroY - gyroY;
+    gyroYOffset = newGyroY - state.load().gyroY;
 }
 
 void NxpAdafruit9Dof::setGyroZ(double newGyroZ){
-    gyroZOffset = newGyroZ - gyroZ;
+    gyroZOffset = newGyroZ - state.load().gyroZ;
+}
+
+NxpAdafruit9Dof::Reading NxpAdafruit9Dof::snapshot() const{
+    Reading reading = state.load();
+    reading.gyroX += gyroXOffset;
+    reading.gyroY += gyroYOffset;
+    reading.gyroZ += gyroZOffset;
+    return reading;
+}
+
+const NxpAdafruit9Dof::History &NxpAdafruit9Dof::getHistory() const{
+    return history;
 }
 
 void NxpAdafruit9Dof::applyDefaultState(){
-    gyroX = 0;
-    gyroY = 0;
-    gyroZ = 0;
-    accelX = 0;
-    accelY = 0;
-    accelZ = 0;
+    state.store(Reading{0, 0, 0, 0, 0, 0});
 
     gyroXOffset = 0;
     gyroYOffset = 0;
@@ -94,16 +99,13 @@ std::vector<uint8_t> NxpAdafruit9Dof::getCreateData(){
     return stringToData("ADDNXPADA9DOF");
 }
 
-void NxpAdafruit9Dof::handleData(const std::vector<uint8_t> &data){
-    // If at least 24 bytes of data (deviceId, data..., crc, crc)
-    if(data.size() >= 27){
-        gyroX = Conversions::convertDataToFloat(data, 1, true);
-        gyroY = Conversions::convertDataToFloat(data, 5, true);
-        gyroZ = Conversions::convertDataToFloat(data, 9, true);
-
-        accelX = Conversions::convertDataToFloat(data, 13, true);
-        accelY = Conversions::convertDataToFloat(data, 17, true);
-        accelZ = Conversions::convertDataToFloat(data, 21, true);
+void NxpAdafruit9Dof::handleData(ByteView data){
+    // data = deviceId, data...
+    ByteView payload = payloadOf(data);
+    ImuFrame frame;
+    if(ImuLayout::decode(payload, frame)){
+        state.store(Reading{frame.gyroX, frame.gyroY, frame.gyroZ, frame.accelX, frame.accelY, frame.accelZ});
+        recordSample(history, snapshot(), payload, ImuLayout::SIZE);
     }
 }
 
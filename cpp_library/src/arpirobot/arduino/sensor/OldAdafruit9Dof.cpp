@@ -19,9 +19,10 @@
 
 #include <arpirobot/arduino/sensor/OldAdafruit9Dof.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/arduino/sensor/SensorFrames.hpp>
 
 using namespace arpirobot;
+using namespace arpirobot::internal;
 
 
 OldAdafruit9Dof::OldAdafruit9Dof(bool createDevice, int deviceId) : ArduinoDevice(createDevice, deviceId){
@@ -32,58 +33,62 @@ void OldAdafruit9Dof::calibrate(uint16_t samples){
     if(arduino == nullptr)
         return;
     Logger::logInfoFrom(getDeviceName(), "Starting calibration. Will not get data until calibration is complete.");
-    std::vector<uint8_t> msg;
-    msg.reserve(3);
-    msg.push_back('C'); // Calibrate command
-    auto s = Conversions::convertInt16ToData(samples, true);
-    msg.insert(msg.end(), s.begin(), s.end());
-    // msg = 'C', samples_little_endian
-    arduino->sendFromDevice(this->deviceId, msg);
+    // msg = 'C' (calibrate command), samples_little_endian
+    uint8_t msg[3] = {'C'};
+    Endian::writeLittle(&msg[1], samples);
+    arduino->sendFromDevice(this->deviceId, ByteView(msg, sizeof(msg)));
 }
 
 double OldAdafruit9Dof::getGyroX(){
-    return gyroX + gyroXOffset;
+    return state.load().gyroX + gyroXOffset;
 }
 
 double OldAdafruit9Dof::getGyroY(){
-    return gyroY + gyroYOffset;
+    return state.load().gyroY + gyroYOffset;
 }
 
 double OldAdafruit9Dof::getGyroZ(){
-    return gyroZ + gyroZOffset;
+    return state.load().gyroZ + gyroZOffset;
 }
 
 double OldAdafruit9Dof::getAccelX(){
-    return accelX;
+    return state.load().accelX;
 }
 
 double OldAdafruit9Dof::getAccelY(){
-    return accelY;
+    return state.load().accelY;
 }
 
 double OldAdafruit9Dof::getAccelZ(){
-    return accelZ;
+    return state.load().accelZ;
 }
 
 void OldAdafruit9Dof::setGyroX(double newGyroX){
-    gyroXOffset = newGyroX - gyroX;
+    gyroXOffset = newGyroX - state.load().gyroX;
 }
 
 void OldAdafruit9Dof::setGyroY(double newGyroY){
-    gyroYOffset = newGyroY - gyroY;
+    gyroYOffset = newGyroY - state.load().gyroY;
 }
 
 void OldAdafruit9Dof::setGyroZ(double newGyroZ){
-    gyroZOffset = newGyroZ - gyroZ;
+    gyroZOffset = newGyroZ - state.load().gyroZ;
+}
+
+OldAdafruit9Dof::Reading OldAdafruit9Dof::snapshot() const{
+    Reading reading = state.load();
+    reading.gyroX += gyroXOffset;
+    reading.gyroY += gyroYOffset;
+    reading.gyroZ += gyroZOffset;
+    return reading;
+}
+
+const OldAdafruit9Dof::History &OldAdafruit9Dof::getHistory() const{
+    return history;
 }
 
 void OldAdafruit9Dof::applyDefaultState(){
-    gyroX = 0;
-    gyroY = 0;
-    gyroZ = 0;
-    accelX = 0;
-    accelY = 0;
-    accelZ = 0;
+    state.store(Reading{0, 0, 0, 0, 0, 0});
 
     gyroXOffset = 0;
     gyroYOffset = 0;
@@ -94,15 +99,12 @@ std::vector<uint8_t> OldAdafruit9Dof::getCreateData(){
     return stringToData("ADDOLDADA9DOF");
 }
 
-void OldAdafruit9Dof::handleData(const std::vector<uint8_t> &data){
-    // If at least 24 bytes of data (deviceId, data..., crc, crc)
-    if(data.size() >= 27){
-        gyroX = Conversions::convertDataToFloat(data, 1, true);
-        gyroY = Conversions::convertDataToFloat(data, 5, true);
-        gyroZ = Conversions::convertDataToFloat(data, 9, true);
-
-        accelX = Conversions::convertDataToFloat(data, 13, true);
-        accelY = Conversions::convertDataToFloat(data, 17, true);
-        accelZ = Conversions::convertDataToFloat(data, 21, true);
+void OldAdafruit9Dof::handleData(ByteView data){
+    // data = deviceId, data...
+    ByteView payload = payloadOf(data);
+    ImuFrame frame;
+    if(ImuLayout::decode(payload, frame)){
+        state.store(Reading{frame.gyroX, frame.gyroY, frame.gyroZ, frame.accelX, frame.accelY, frame.accelZ});
+        recordSample(history, snapshot(), payload, ImuLayout::SIZE);
     }
 }
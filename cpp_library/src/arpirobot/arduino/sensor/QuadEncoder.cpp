@@ -19,9 +19,11 @@
 
 #include <arpirobot/arduino/sensor/QuadEncoder.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/core/network/Telemetry.hpp>
+#include <arpirobot/arduino/sensor/SensorFrames.hpp>
 
 using namespace arpirobot;
+using namespace arpirobot::internal;
 
 
 QuadEncoder::QuadEncoder(int pinA, int pinB, bool useInternalPullup, bool createDevice, int deviceId) : 
@@ -47,22 +49,44 @@ QuadEncoder::QuadEncoder(std::string pinA, std::string pinB, bool useInternalPul
     deviceName = "QuadEncoder(" + this->pinA + ", " + this->pinB + ")";
 }
 
+QuadEncoder::~QuadEncoder(){
+    Telemetry::removeSource(telemetrySourceId);
+}
+
 int32_t QuadEncoder::getPosition(){
-    return count + countOffset;
+    return snapshot().position;
 }
 
 void QuadEncoder::setPosition(int32_t newPosition){
-    countOffset = newPosition - count;
+    countOffset = newPosition - state.load().position;
 }
 
 float QuadEncoder::getVelocity(){
-    return velocity;
+    return state.load().velocity;
+}
+
+QuadEncoder::Reading QuadEncoder::snapshot() const{
+    Reading reading = state.load();
+    reading.position += countOffset;
+    return reading;
+}
+
+const QuadEncoder::History &QuadEncoder::getHistory() const{
+    return history;
+}
+
+int QuadEncoder::addTelemetrySource(){
+    Telemetry::removeSource(telemetrySourceId);
+    telemetrySourceId = Telemetry::addSource(getDeviceName(), {"position", "velocity"}, [this](float *values){
+        values[0] = getPosition();
+        values[1] = getVelocity();
+    });
+    return telemetrySourceId;
 }
 
 void QuadEncoder::applyDefaultState(){
-    count = 0;
+    state.store(Reading{0, 0.0f});
     countOffset = 0;
-    velocity = 0.0f;
 }
 
 std::vector<uint8_t> QuadEncoder::getCreateData(){
@@ -95,11 +119,12 @@ std::vector<uint8_t> QuadEncoder::getCreateData(){
     return data;
 }
 
-void QuadEncoder::handleData(const std::vector<uint8_t> &data){
-    // Buffer contains deviceId, data..., crc, crc
-    if(data.size() >= 11){
-        // Contains 32-bit count (int) and 32-bit velocity (float)
-        count = Conversions::convertDataToInt32(data, 1, true);
-        velocity = Conversions::convertDataToFloat(data, 5, true);
+void QuadEncoder::handleData(ByteView data){
+    // Buffer contains deviceId, data...
+    ByteView payload = payloadOf(data);
+    EncoderFrame frame;
+    if(EncoderLayout::decode(payload, frame)){
+        state.store(Reading{frame.count, frame.velocity});
+        recordSample(history, snapshot(), payload, EncoderLayout::SIZE);
     }
 }
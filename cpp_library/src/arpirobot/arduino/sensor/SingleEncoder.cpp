@@ -19,9 +19,10 @@
 
 #include <arpirobot/arduino/sensor/SingleEncoder.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/arduino/sensor/SensorFrames.hpp>
 
 using namespace arpirobot;
+using namespace arpirobot::internal;
 
 
 SingleEncoder::SingleEncoder(int pin, bool useInternalPullup, bool createDevice, int deviceId) : 
@@ -35,21 +36,30 @@ SingleEncoder::SingleEncoder(std::string pin, bool useInternalPullup, bool creat
 }
 
 int32_t SingleEncoder::getPosition(){
-    return count + countOffset;
+    return snapshot().position;
 }
 
 void SingleEncoder::setPosition(int32_t newPosition){
-    countOffset = newPosition - count;
+    countOffset = newPosition - state.load().position;
 }
 
 float SingleEncoder::getVelocity(){
-    return velocity;
+    return state.load().velocity;
+}
+
+SingleEncoder::Reading SingleEncoder::snapshot() const{
+    Reading reading = state.load();
+    reading.position += countOffset;
+    return reading;
+}
+
+const SingleEncoder::History &SingleEncoder::getHistory() const{
+    return history;
 }
 
 void SingleEncoder::applyDefaultState(){
-    count = 0;
+    state.store(Reading{0, 0.0f});
     countOffset = 0;
-    velocity = 0.0f;
 }
 
 std::vector<uint8_t> SingleEncoder::getCreateData(){
@@ -74,15 +84,20 @@ std::vector<uint8_t> SingleEncoder::getCreateData(){
     return data;
 }
 
-void SingleEncoder::handleData(const std::vector<uint8_t> &data){
-    // Buffer contains deviceId, data..., crc, crc
-    if(data.size() >= 11){
-        // New format. Contains 32-bit count (int) and 32-bit velocity (float)
-        count = Conversions::convertDataToInt32(data, 1, true);
-        velocity = Conversions::convertDataToFloat(data, 5, true);
-    }else if(data.size() >= 5){
+void SingleEncoder::handleData(ByteView data){
+    // Buffer contains deviceId, data...
+    ByteView payload = payloadOf(data);
+    EncoderFrame frame;
+    if(EncoderLayout::decode(payload, frame)){
+        // New format
+        state.store(Reading{frame.count, frame.velocity});
+        recordSample(history, snapshot(), payload, EncoderLayout::SIZE);
+    }else if(payload.size() >= 2){
         // Old format. Count is 16-bit. No velocity data
         // At least 2 bytes of data. Position is included
-        count = Conversions::convertDataToInt16(data, 1, true);
+        Reading reading = state.load();
+        reading.position = Endian::readLittle<int16_t>(payload.data());
+        state.store(reading);
+        recordSample(history, snapshot(), payload, 2);
     }
 }
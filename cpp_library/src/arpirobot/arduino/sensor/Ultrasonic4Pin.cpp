@@ -19,7 +19,7 @@
 
 #include <arpirobot/arduino/sensor/Ultrasonic4Pin.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/core/util/Endian.hpp>
 
 using namespace arpirobot;
 
@@ -44,12 +44,20 @@ Ultrasonic4Pin::Ultrasonic4Pin(std::string triggerPin, std::string echoPin, bool
 }
 
 int Ultrasonic4Pin::getDistance(){
-    return distance;
+    return state.load().distance;
+}
+
+Ultrasonic4Pin::Reading Ultrasonic4Pin::snapshot() const{
+    return state.load();
+}
+
+const Ultrasonic4Pin::History &Ultrasonic4Pin::getHistory() const{
+    return history;
 }
 
 
 void Ultrasonic4Pin::applyDefaultState(){
-    distance = 0;
+    state.store(Reading{0});
 }
 
 std::vector<uint8_t> Ultrasonic4Pin::getCreateData(){
@@ -86,11 +94,14 @@ std::vector<uint8_t> Ultrasonic4Pin::getCreateData(){
     return data;
 }
 
-void Ultrasonic4Pin::handleData(const std::vector<uint8_t> &data){
-    // Buffer will contain deviceId, data..., crc, crc
-    if(data.size() >= 5){
+void Ultrasonic4Pin::handleData(ByteView data){
+    // Buffer will contain deviceId, data...
+    ByteView payload = payloadOf(data);
+    if(payload.size() >= 2){
         // At least 2 bytes of data
         // distance is 16-bit int, little endian
-        distance = Conversions::convertDataToInt16(data, 1, true);
+        Reading reading{Endian::readLittle<int16_t>(payload.data())};
+        state.store(reading);
+        recordSample(history, reading, payload, 2);
     }
 }
@@ -19,7 +19,7 @@
 
 #include <arpirobot/arduino/sensor/VoltageMonitor.hpp>
 #include <arpirobot/core/log/Logger.hpp>
-#include <arpirobot/core/conversions.hpp>
+#include <arpirobot/core/util/Endian.hpp>
 
 using namespace arpirobot;
 
@@ -35,11 +35,19 @@ VoltageMonitor::VoltageMonitor(int pin, double vboard, int r1, int r2, bool crea
 }
 
 double VoltageMonitor::getVoltage(){
-    return voltage;
+    return state.load().voltage;
+}
+
+VoltageMonitor::Reading VoltageMonitor::snapshot() const{
+    return state.load();
+}
+
+const VoltageMonitor::History &VoltageMonitor::getHistory() const{
+    return history;
 }
 
 void VoltageMonitor::applyDefaultState(){
-    voltage = 0;
+    state.store(Reading{0});
 }
 
 std::vector<uint8_t> VoltageMonitor::getCreateData(){
@@ -55,20 +63,9 @@ std::vector<uint8_t> VoltageMonitor::getCreateData(){
         std::vector<uint8_t> data = stringToData("ADDVMON");
         data.push_back(p);
 
-        std::vector<uint8_t> vboardData = Conversions::convertFloatToData(vboard, false);
-        for(uint8_t b : vboardData){
-            data.push_back(b);
-        }
-
-        std::vector<uint8_t> r1Data = Conversions::convertInt32ToData(r1, false);
-        for(uint8_t b : r1Data){
-            data.push_back(b);
-        }
-
-        std::vector<uint8_t> r2Data = Conversions::convertInt32ToData(r2, false);
-        for(uint8_t b : r2Data){
-            data.push_back(b);
-        }
+        Endian::append(data, (float)vboard, ByteOrder::Big);
+        Endian::append(data, (int32_t)r1, ByteOrder::Big);
+        Endian::append(data, (int32_t)r2, ByteOrder::Big);
 
         return data;
     }catch(const std::runtime_error &e){
@@ -78,11 +75,14 @@ std::vector<uint8_t> VoltageMonitor::getCreateData(){
     return {};
 }
 
-void VoltageMonitor::handleData(const std::vector<uint8_t> &data){
-    if(data.size() >= 5){
-        voltage = Conversions::convertDataToFloat(data, 1, true);
+void VoltageMonitor::handleData(ByteView data){
+    ByteView payload = payloadOf(data);
+    if(payload.size() >= 4){
+        Reading reading{Endian::readLittle<float>(payload.data())};
+        state.store(reading);
+        recordSample(history, reading, payload, 4);
         if(isMainVmon()){
-            sendMainBatteryVoltage(voltage);
+            sendMainBatteryVoltage(reading.voltage);
         }
     }
 }
@@ -219,6 +219,46 @@ BRIDGE_FUNC char *RobotProfile_getIoProvider(){
     return returnableString(RobotProfile::ioProvider);
 }
 
+BRIDGE_FUNC void RobotProfile_setNetworkBindAddress(const char *networkBindAddress){
+    RobotProfile::networkBindAddress = std::string(networkBindAddress);
+}
+
+BRIDGE_FUNC char *RobotProfile_getNetworkBindAddress(){
+    return returnableString(RobotProfile::networkBindAddress);
+}
+
+BRIDGE_FUNC void RobotProfile_setControllerPort(int controllerPort){
+    RobotProfile::controllerPort = controllerPort;
+}
+
+BRIDGE_FUNC int RobotProfile_getControllerPort(){
+    return RobotProfile::controllerPort;
+}
+
+BRIDGE_FUNC void RobotProfile_setCommandPort(int commandPort){
+    RobotProfile::commandPort = commandPort;
+}
+
+BRIDGE_FUNC int RobotProfile_getCommandPort(){
+    return RobotProfile::commandPort;
+}
+
+BRIDGE_FUNC void RobotProfile_setNetTablePort(int netTablePort){
+    RobotProfile::netTablePort = netTablePort;
+}
+
+BRIDGE_FUNC int RobotProfile_getNetTablePort(){
+    return RobotProfile::netTablePort;
+}
+
+BRIDGE_FUNC void RobotProfile_setLogPort(int logPort){
+    RobotProfile::logPort = logPort;
+}
+
+BRIDGE_FUNC int RobotProfile_getLogPort(){
+    return RobotProfile::logPort;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// MainVMon Bridge
@@ -289,6 +329,22 @@ BRIDGE_FUNC void Logger_logNewline(){
     Logger::logNewline();
 }
 
+BRIDGE_FUNC void Logger_setLevel(int level){
+    Logger::setLevel(static_cast<Logger::Level>(level));
+}
+
+BRIDGE_FUNC int Logger_getLevel(){
+    return static_cast<int>(Logger::getLevel());
+}
+
+BRIDGE_FUNC void Logger_setSourceLevel(const char *source, int level){
+    Logger::setSourceLevel(std::string(source), static_cast<Logger::Level>(level));
+}
+
+BRIDGE_FUNC void Logger_clearSourceLevel(const char *source){
+    Logger::clearSourceLevel(std::string(source));
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// BaseDevice bridge
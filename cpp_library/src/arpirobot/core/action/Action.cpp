@@ -83,7 +83,7 @@ void Action::actionStart(bool skipLock){
             }
         }catch(const std::runtime_error &e){
             Logger::logWarning("Action encountered exception when running lockedDevices().");
-            Logger::logDebug(e.what());
+            ARPIROBOT_LOG_DEBUG(e.what());
             currentlyLocked = {};
         }
     }
@@ -92,7 +92,7 @@ void Action::actionStart(bool skipLock){
         begin();
     }catch(const std::runtime_error &e){
         Logger::logWarning("Action encountered exception when running begin().");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
     }
 }
 
@@ -106,7 +106,7 @@ void Action::actionStop(bool interrupted){
         finish(interrupted);
     }catch(const std::runtime_error &e){
         Logger::logWarning("Action encountered exception when running finish().");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
     }
     for(auto dev : currentlyLocked){
         dev.get().releaseDevice(this);
@@ -127,14 +127,14 @@ void Action::actionProcess(){
         process();
     }catch(const std::runtime_error &e){
         Logger::logWarning("Action encountered exception when running process().");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
     }
 
     try{
         cont = shouldContinue();
     }catch(const std::runtime_error &e){
         Logger::logWarning("Action encountered exception when running shouldContinue().");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
     }
 
     if(!cont){
@@ -110,7 +110,7 @@ bool ActionManager::startActionInternal(std::shared_ptr<Action> action, bool doR
         );
         return true;
     }else{
-        Logger::logDebugFrom("ActionManager", "Attempted to start already running action.");
+        ARPIROBOT_LOG_DEBUG_FROM("ActionManager", "Attempted to start already running action.");
         return false;
     }
 }
@@ -91,7 +91,7 @@ void ActionSeries::process(){
         }
     }catch(const std::runtime_error &e){
         Logger::logError("An ActionSeries ran into an error handling actions. Its behavior is now unpredictable. The ActionSeries will now be stopped.");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
         ActionManager::stopAction(*this);
     }
 }
@@ -108,7 +108,7 @@ int AudioManager::playSound(std::string file, AudioDeviceInfo info){
     ma_result res = ma_device_init(NULL, &deviceConfig, &setup->device);
     if(res != MA_SUCCESS){
         Logger::logWarningFrom("AudioManager", "Unable to init device for playback.");
-        Logger::logDebugFrom("AudioManager", "Error code: " + std::to_string(res));
+        ARPIROBOT_LOG_DEBUG_FROM("AudioManager", "Error code: " + std::to_string(res));
         ma_decoder_uninit(&setup->decoder);
         playbackSetups.erase(&setup->device);
         delete  setup;
@@ -118,7 +118,7 @@ int AudioManager::playSound(std::string file, AudioDeviceInfo info){
     res = ma_device_start(&setup->device);
     if(res != MA_SUCCESS){
         Logger::logWarningFrom("AudioManager", "Unable to start device for playback.");
-        Logger::logDebugFrom("AudioManager", "Error code: " + std::to_string(res));
+        ARPIROBOT_LOG_DEBUG_FROM("AudioManager", "Error code: " + std::to_string(res));
         ma_device_uninit(&setup->device);
         ma_decoder_uninit(&setup->decoder);
         playbackSetups.erase(&setup->device);
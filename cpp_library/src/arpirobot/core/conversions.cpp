@@ -18,6 +18,7 @@
  */
 
 #include <arpirobot/core/conversions.hpp>
+#include <arpirobot/core/util/Endian.hpp>
 
 using namespace arpirobot;
 
@@ -34,97 +35,31 @@ void Conversions::checkBigEndian(){
 }
 
 std::vector<uint8_t> Conversions::convertInt32ToData(int32_t input, bool littleEndian){
-    std::vector<uint8_t> data;
-    data.reserve(4);
-    if(littleEndian){
-        data.push_back(input);
-        data.push_back(input >> 8);
-        data.push_back(input >> 16);
-        data.push_back(input >> 24);
-    }else{
-        data.push_back(input >> 24);
-        data.push_back(input >> 16);
-        data.push_back(input >> 8);
-        data.push_back(input);
-    }
+    std::vector<uint8_t> data(4);
+    Endian::write(data.data(), input, littleEndian ? ByteOrder::Little : ByteOrder::Big);
     return data;
 }
 
-int32_t Conversions::convertDataToInt32(const std::vector<uint8_t> &data, size_t offset, bool littleEndian){
-    if(littleEndian){
-        return data[offset] | 
-               data[offset + 1] << 8 | 
-               data[offset + 2] << 16 |
-               data[offset + 3] << 24;
-    }else{
-        return data[offset] << 24| 
-               data[offset + 1] << 16 | 
-               data[offset + 2] << 8 |
-               data[offset + 3];
-    }
+int32_t Conversions::convertDataToInt32(ByteView data, size_t offset, bool littleEndian){
+    return Endian::read<int32_t>(&data[offset], littleEndian ? ByteOrder::Little : ByteOrder::Big);
 }
 
 std::vector<uint8_t> Conversions::convertInt16ToData(int16_t input, bool littleEndian){
-    std::vector<uint8_t> data;
-    data.reserve(2);
-    if(littleEndian){
-        data.push_back(input);
-        data.push_back(input >> 8);
-    }else{
-        data.push_back(input >> 8);
-        data.push_back(input);
-    }
+    std::vector<uint8_t> data(2);
+    Endian::write(data.data(), input, littleEndian ? ByteOrder::Little : ByteOrder::Big);
     return data;
 }
 
-int16_t Conversions::convertDataToInt16(const std::vector<uint8_t> &data, size_t offset, bool littleEndian){
-    if(littleEndian){
-        return data[offset] | data[offset + 1] << 8;
-    }else{
-        return data[offset] << 8 | data[offset + 1];
-    }
+int16_t Conversions::convertDataToInt16(ByteView data, size_t offset, bool littleEndian){
+    return Endian::read<int16_t>(&data[offset], littleEndian ? ByteOrder::Little : ByteOrder::Big);
 }
 
 std::vector<uint8_t> Conversions::convertFloatToData(float input, bool littleEndian){
-    std::vector<uint8_t> data;
-    data.reserve(4);
-
-    // Pointer to leftmost byte of input
-    uint8_t *ptr = (uint8_t*)&input;
-    
-    if(isBigEndian == littleEndian){
-        // System endianess and desired endianess different, so reverse order
-        data.push_back(ptr[3]);
-        data.push_back(ptr[2]);
-        data.push_back(ptr[1]);
-        data.push_back(ptr[0]);
-    }else{
-        // System endianess and desired endianess match, so no need to reverse order
-        data.push_back(ptr[0]);
-        data.push_back(ptr[1]);
-        data.push_back(ptr[2]);
-        data.push_back(ptr[3]);
-    }
-
+    std::vector<uint8_t> data(4);
+    Endian::write(data.data(), input, littleEndian ? ByteOrder::Little : ByteOrder::Big);
     return data;
 }
 
-float Conversions::convertDataToFloat(const std::vector<uint8_t> &data, size_t offset, bool littleEndian){
-    uint8_t dataRaw[4];
-    
-    if(isBigEndian == littleEndian){
-        // System endianess and desired endianess different, so reverse order
-        dataRaw[0] = data[offset + 3];
-        dataRaw[1] = data[offset + 2];
-        dataRaw[2] = data[offset + 1];
-        dataRaw[3] = data[offset];
-    }else{
-        // System endianess and desired endianess match, so no need to reverse order
-        dataRaw[0] = data[offset];
-        dataRaw[1] = data[offset + 1];
-        dataRaw[2] = data[offset + 2];
-        dataRaw[3] = data[offset + 3];
-    }
-    // Dereference pointer to start of dataRaw interpreted as float
-    return *((float*)(dataRaw));
-}
\ No newline at end of file
+float Conversions::convertDataToFloat(ByteView data, size_t offset, bool littleEndian){
+    return Endian::read<float>(&data[offset], littleEndian ? ByteOrder::Little : ByteOrder::Big);
+}
@@ -80,7 +80,7 @@ void BaseDevice::releaseDevice(Action *action){
 void BaseDevice::doBegin(){
     if(!initialized){
         begin();
-        Logger::logDebugFrom(getDeviceName(), "Device started.");
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), "Device started.");
         initialized = true;
     }
 }
\ No newline at end of file
@@ -18,6 +18,9 @@
  */
 
 #include <arpirobot/core/device/MotorController.hpp>
+#include <arpirobot/core/diag/LatencyTracer.hpp>
+#include <arpirobot/core/diag/FlightRecorder.hpp>
+#include <arpirobot/core/network/Telemetry.hpp>
 
 
 using namespace arpirobot;
@@ -58,6 +61,18 @@ double MotorController::getSpeed(){
     }
 }
 
+MotorController::~MotorController(){
+    Telemetry::removeSource(telemetrySourceId);
+}
+
+int MotorController::addTelemetrySource(){
+    Telemetry::removeSource(telemetrySourceId);
+    telemetrySourceId = Telemetry::addSource(getDeviceName(), {"speed"}, [this](float *values){
+        values[0] = getSpeed();
+    });
+    return telemetrySourceId;
+}
+
 void MotorController::setSpeed(double speed){
     if(!enabled)
         return;
@@ -72,6 +87,8 @@ void MotorController::setSpeed(double speed){
         std::lock_guard<std::mutex> l(lock);
         this->speed = speed * speedFactor;
         run();
+        LatencyTracer::noteOutput(deviceName, lastTraceFrame);
+        FlightRecorder::recordMotor(deviceName, this->speed);
     }
 }
 
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/diag/FlightRecorder.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+#include <arpirobot/core/log/Logger.hpp>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace arpirobot;
+
+static_assert(sizeof(FlightRecorderHeader) == 64, "Flight recorder header must be 64 bytes");
+static_assert(sizeof(FlightRecord) == 128, "Flight records must be 128 bytes");
+
+const char FlightRecorder::MAGIC[8] = {'A', 'R', 'P', 'I', 'F', 'R', 'E', 'C'};
+std::atomic<bool> FlightRecorder::enabled {false};
+std::atomic<uint64_t> FlightRecorder::nextSeq {1};
+FlightRecord *FlightRecorder::records = nullptr;
+uint64_t FlightRecorder::slotCount = 0;
+size_t FlightRecorder::mappedSize = 0;
+void *FlightRecorder::mapping = nullptr;
+int64_t FlightRecorder::startTimeNs = 0;
+
+
+bool FlightRecorder::start(){
+    if(enabled)
+        return true;
+    if(RobotProfile::flightRecorderFile.empty())
+        return false;
+
+#ifdef __linux__
+    // Writers may still be using an older mapping, so it is never unmapped. Reuse it.
+    if(mapping == nullptr){
+        const std::string &file = RobotProfile::flightRecorderFile;
+        uint64_t slots = RobotProfile::flightRecorderSize / sizeof(FlightRecord);
+        if(slots < 16)
+            slots = 16;
+        size_t size = sizeof(FlightRecorderHeader) + slots * sizeof(FlightRecord);
+
+        // Keep the last recording (likely the one that is needed after a crash)
+        std::rename(file.c_str(), (file + ".1").c_str());
+
+        int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0){
+            Logger::logWarningFrom("FlightRecorder", "Unable to open " + file + ": " + std::strerror(errno));
+            return false;
+        }
+
+        // Allocate the whole file now so writes to the mapping can't fail later (SIGBUS if the disk is full)
+        int res = posix_fallocate(fd, 0, size);
+        if(res != 0){
+            Logger::logWarningFrom("FlightRecorder", "Unable to allocate " + file + ": " + std::strerror(res));
+            ::close(fd);
+            return false;
+        }
+
+        void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(addr == MAP_FAILED){
+            Logger::logWarningFrom("FlightRecorder", "Unable to map " + file + ": " + std::strerror(errno));
+            return false;
+        }
+
+        FlightRecorderHeader *header = static_cast<FlightRecorderHeader*>(addr);
+        std::memset(header, 0, sizeof(FlightRecorderHeader));
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->recordSize = sizeof(FlightRecord);
+        header->slotCount = slots;
+        header->startTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        mapping = addr;
+        mappedSize = size;
+        slotCount = slots;
+        records = reinterpret_cast<FlightRecord*>(static_cast<uint8_t*>(addr) + sizeof(FlightRecorderHeader));
+        startTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    enabled = true;
+    Logger::logInfoFrom("FlightRecorder", "Recording to " + RobotProfile::flightRecorderFile);
+    return true;
+#else
+    Logger::logWarningFrom("FlightRecorder", "Flight recorder is only supported on Linux.");
+    return false;
+#endif
+}
+
+void FlightRecorder::stop(){
+    if(!enabled)
+        return;
+    enabled = false;
+#ifdef __linux__
+    msync(mapping, mappedSize, MS_SYNC);
+#endif
+}
+
+void FlightRecorder::recordLog(const std::string &line){
+    record(RecordType::Log, 0, line.data(), line.size());
+}
+
+void FlightRecorder::recordState(bool robotEnabled){
+    record(RecordType::State, robotEnabled ? 1 : 0, nullptr, 0);
+}
+
+void FlightRecorder::recordNetTable(const std::string &key, const std::string &value, bool fromDs){
+    if(!isEnabled())
+        return;
+
+    // key,255,value (same as the network protocol)
+    uint8_t buf[sizeof(FlightRecord::data)];
+    size_t keyLen = std::min(key.size(), sizeof(buf) - 1);
+    std::memcpy(buf, key.data(), keyLen);
+    buf[keyLen] = 255;
+    record(RecordType::NetTable, fromDs ? 1 : 0, buf, keyLen + 1, value.data(), value.size());
+}
+
+void FlightRecorder::recordController(int controller, const uint8_t *packet, size_t length){
+    record(RecordType::Controller, (uint16_t)controller, packet, length);
+}
+
+void FlightRecorder::recordMotor(const std::string &device, double speed){
+    float s = (float)speed;
+    record(RecordType::Motor, 0, &s, sizeof(s), device.data(), device.size());
+}
+
+void FlightRecorder::record(RecordType type, uint16_t sub, const void *data1, size_t len1, 
+        const void *data2, size_t len2){
+    if(!isEnabled())
+        return;
+
+    uint64_t seq = nextSeq.fetch_add(1, std::memory_order_relaxed);
+    FlightRecord &rec = records[(seq - 1) % slotCount];
+
+    // Mark the slot incomplete before overwriting the older record in it
+    __atomic_store_n(&rec.seq, 0, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    rec.timeUs = (uint64_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count() - startTimeNs) / 1000;
+    rec.type = (uint8_t)type;
+    rec.sub = sub;
+    rec.reserved = 0;
+    size_t n1 = std::min(len1, sizeof(rec.data));
+    if(n1 > 0)
+        std::memcpy(rec.data, data1, n1);
+    size_t n2 = std::min(len2, sizeof(rec.data) - n1);
+    if(n2 > 0)
+        std::memcpy(rec.data + n1, data2, n2);
+    rec.length = (uint8_t)(n1 + n2);
+
+    __atomic_store_n(&rec.seq, seq, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/diag/HandlerStats.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+using namespace arpirobot;
+
+
+void HandlerStats::record(uint64_t wallNs, uint64_t cpuNs, uint64_t items){
+    calls.fetch_add(1, std::memory_order_relaxed);
+    this->items.fetch_add(items, std::memory_order_relaxed);
+    this->cpuNs.fetch_add(cpuNs, std::memory_order_relaxed);
+    latency.record(wallNs);
+}
+
+uint64_t HandlerStats::getCalls() const{
+    return calls.load(std::memory_order_relaxed);
+}
+
+uint64_t HandlerStats::getItems() const{
+    return items.load(std::memory_order_relaxed);
+}
+
+uint64_t HandlerStats::getCpuNs() const{
+    return cpuNs.load(std::memory_order_relaxed);
+}
+
+const LatencyHistogram &HandlerStats::getLatency() const{
+    return latency;
+}
+
+void HandlerStats::reset(){
+    calls = 0;
+    items = 0;
+    cpuNs = 0;
+    latency.reset();
+}
+
+uint64_t HandlerStats::threadCpuNs(){
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0){
+        return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+    return 0;
+}
+
+
+HandlerTimer::HandlerTimer(HandlerStats &stats, uint64_t items) : stats(stats), 
+        active(RobotProfile::handlerStats), items(items), startCpu(0){
+    if(active){
+        startTime = std::chrono::steady_clock::now();
+        startCpu = HandlerStats::threadCpuNs();
+    }
+}
+
+HandlerTimer::~HandlerTimer(){
+    if(!active)
+        return;
+    uint64_t cpu = HandlerStats::threadCpuNs() - startCpu;
+    uint64_t wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    stats.record(wall, cpu, items);
+}
+
+void HandlerTimer::setItems(uint64_t items){
+    this->items = items;
+}
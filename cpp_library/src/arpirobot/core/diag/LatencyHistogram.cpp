@@ -0,0 +1,116 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
+
+using namespace arpirobot;
+
+
+LatencyHistogram::LatencyHistogram(){
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t value){
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = minValue.load(std::memory_order_relaxed);
+    while(value < current && !minValue.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    current = maxValue.load(std::memory_order_relaxed);
+    while(value > current && !maxValue.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const{
+    uint64_t n = count();
+    if(n == 0)
+        return 0;
+    if(percentile < 0)
+        percentile = 0;
+    if(percentile > 100)
+        percentile = 100;
+
+    // Rank of the value to find (1 based)
+    uint64_t rank = (uint64_t)(percentile / 100.0 * n + 0.5);
+    if(rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < BUCKET_COUNT; ++i){
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if(seen >= rank){
+            // Bucket bound can be larger than any value actually recorded
+            uint64_t bound = bucketUpperBound(i);
+            uint64_t largest = max();
+            return bound < largest ? bound : largest;
+        }
+    }
+    return max();
+}
+
+uint64_t LatencyHistogram::count() const{
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::min() const{
+    return count() == 0 ? 0 : minValue.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::max() const{
+    return maxValue.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const{
+    uint64_t n = count();
+    return n == 0 ? 0 : (double)sum.load(std::memory_order_relaxed) / n;
+}
+
+void LatencyHistogram::reset(){
+    for(auto &bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minValue.store(UINT64_MAX, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value){
+    // Values less than SUB_BUCKETS get their own bucket. Larger values are grouped by 
+    // most significant bit, then by the next three bits.
+    if(value < SUB_BUCKETS)
+        return value;
+#if defined(__GNUC__)
+    int msb = 63 - __builtin_clzll(value);
+#else
+    int msb = 63;
+    while(!(value & (1ULL << msb)))
+        msb--;
+#endif
+    size_t sub = (value >> (msb - 3)) & (SUB_BUCKETS - 1);
+    return (msb - 2) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index){
+    if(index < SUB_BUCKETS)
+        return index;
+    int msb = index / SUB_BUCKETS + 2;
+    uint64_t sub = index % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub) << (msb - 3);
+    return lower + (1ULL << (msb - 3)) - 1;
+}
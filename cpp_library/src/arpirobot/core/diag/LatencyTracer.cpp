@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/diag/LatencyTracer.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+#include <fstream>
+#include <algorithm>
+
+
+using namespace arpirobot;
+
+
+thread_local LatencyTracer::Context LatencyTracer::context;
+std::atomic<uint64_t> LatencyTracer::frameCounter {0};
+std::atomic<uint64_t> LatencyTracer::lastReadFrame {0};
+LatencyHistogram LatencyTracer::inputToOutput;
+LatencyHistogram LatencyTracer::inputToRead;
+std::mutex LatencyTracer::recordsLock;
+std::vector<LatencyTracer::TraceRecord> LatencyTracer::records;
+size_t LatencyTracer::nextRecord = 0;
+
+static int64_t toUs(std::chrono::steady_clock::time_point t){
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+static uint64_t elapsedNs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+bool LatencyTracer::isEnabled(){
+    return RobotProfile::latencyTracing;
+}
+
+uint64_t LatencyTracer::nextFrame(){
+    return ++frameCounter;
+}
+
+void LatencyTracer::noteInput(uint64_t frame, int controller, std::chrono::steady_clock::time_point arrivalTime){
+    if(frame == 0 || !isEnabled())
+        return;
+
+    // If multiple controllers are read, outputs are attributed to the newest data
+    if(context.frame != 0 && context.arrivalTime > arrivalTime)
+        return;
+    if(context.frame == frame)
+        return;
+
+    context.frame = frame;
+    context.controller = controller;
+    context.arrivalTime = arrivalTime;
+    context.readTime = std::chrono::steady_clock::now();
+
+    // Only the first read of a frame (by any thread) counts
+    uint64_t last = lastReadFrame.load();
+    while(frame > last){
+        if(lastReadFrame.compare_exchange_weak(last, frame)){
+            inputToRead.record(elapsedNs(arrivalTime, context.readTime));
+            break;
+        }
+    }
+}
+
+void LatencyTracer::noteOutput(const std::string &device, uint64_t &lastFrame){
+    if(context.frame == 0 || context.frame <= lastFrame || !isEnabled())
+        return;
+    lastFrame = context.frame;
+
+    TraceRecord record;
+    record.frame = context.frame;
+    record.controller = context.controller;
+    record.arrivalTime = context.arrivalTime;
+    record.readTime = context.readTime;
+    record.outputTime = std::chrono::steady_clock::now();
+    record.device = device;
+    inputToOutput.record(elapsedNs(record.arrivalTime, record.outputTime));
+
+    std::lock_guard<std::mutex> l(recordsLock);
+    size_t capacity = std::max(RobotProfile::latencyTraceRecords, 1);
+    if(records.size() < capacity){
+        records.push_back(record);
+        nextRecord = records.size() % capacity;
+    }else{
+        records[nextRecord] = record;
+        nextRecord = (nextRecord + 1) % records.size();
+    }
+}
+
+void LatencyTracer::clearContext(){
+    context.frame = 0;
+}
+
+const LatencyHistogram &LatencyTracer::getInputToOutputLatency(){
+    return inputToOutput;
+}
+
+const LatencyHistogram &LatencyTracer::getInputToReadLatency(){
+    return inputToRead;
+}
+
+std::vector<LatencyTracer::TraceRecord> LatencyTracer::getRecords(){
+    std::lock_guard<std::mutex> l(recordsLock);
+    std::vector<TraceRecord> result;
+    result.reserve(records.size());
+    for(size_t i = 0; i < records.size(); ++i){
+        result.push_back(records[(nextRecord + i) % records.size()]);
+    }
+    return result;
+}
+
+bool LatencyTracer::exportCsv(const std::string &filename){
+    std::ofstream file(filename);
+    if(!file.is_open())
+        return false;
+    file << "frame,controller,arrival_us,read_us,output_us,read_latency_us,output_latency_us,device\n";
+    for(const TraceRecord &r : getRecords()){
+        file << r.frame << "," << r.controller << "," << toUs(r.arrivalTime) << "," << toUs(r.readTime) << "," 
+            << toUs(r.outputTime) << "," << (toUs(r.readTime) - toUs(r.arrivalTime)) << "," 
+            << (toUs(r.outputTime) - toUs(r.arrivalTime)) << "," << r.device << "\n";
+    }
+    return file.good();
+}
+
+void LatencyTracer::reset(){
+    inputToOutput.reset();
+    inputToRead.reset();
+    std::lock_guard<std::mutex> l(recordsLock);
+    records.clear();
+    nextRecord = 0;
+}
@@ -20,6 +20,8 @@
 
 #include <arpirobot/core/io/DummyIoProvider.hpp>
 #include <arpirobot/core/log/Logger.hpp>
+#include <chrono>
+#include <thread>
 
 using namespace arpirobot;
 
@@ -39,29 +41,29 @@ DummyIoProvider::~DummyIoProvider(){
 /// GPIO & PWM
 ////////////////////////////////////////////////////////////////////////
 void DummyIoProvider::gpioMode(unsigned int pin, unsigned int mode){
-    Logger::logDebugFrom("DummyIoProvider", "gpioMode(" + std::to_string(pin) + ", " + std::to_string(mode) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "gpioMode(" + std::to_string(pin) + ", " + std::to_string(mode) + ")");
 }
 
 void DummyIoProvider::gpioWrite(unsigned int pin, unsigned int state){
-    Logger::logDebugFrom("DummyIoProvider", "gpioWrite(" + std::to_string(pin) + ", " + std::to_string(state) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "gpioWrite(" + std::to_string(pin) + ", " + std::to_string(state) + ")");
 }
 
 unsigned int DummyIoProvider::gpioRead(unsigned int pin){
-    Logger::logDebugFrom("DummyIoProvider", "gpioRead(" + std::to_string(pin) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "gpioRead(" + std::to_string(pin) + ")");
     return 0;
 }
 
 void DummyIoProvider::gpioSetPwmFrequency(unsigned int pin, unsigned int frequency){
-    Logger::logDebugFrom("DummyIoProvider", "gpioSetPwmFrequency(" + std::to_string(pin) + ", " + std::to_string(frequency) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "gpioSetPwmFrequency(" + std::to_string(pin) + ", " + std::to_string(frequency) + ")");
 }
 
 unsigned int DummyIoProvider::gpioGetPwmFrequency(unsigned int pin){
-    Logger::logDebugFrom("DummyIoProvider", "gpioGetPwmFrequency(" + std::to_string(pin) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "gpioGetPwmFrequency(" + std::to_string(pin) + ")");
     return 0;
 }
 
 void DummyIoProvider::gpioPwm(unsigned int pin, unsigned int value){
-    Logger::logDebugFrom("DummyIoProvider", "gpioPwm(" + std::to_string(pin) + ", " + std::to_string(value) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "gpioPwm(" + std::to_string(pin) + ", " + std::to_string(value) + ")");
 }
 
 
@@ -69,47 +71,47 @@ void DummyIoProvider::gpioPwm(unsigned int pin, unsigned int value){
 /// I2C
 ////////////////////////////////////////////////////////////////////////
 unsigned int DummyIoProvider::i2cOpen(unsigned int bus, unsigned int address){
-    Logger::logDebugFrom("DummyIoProvider", "i2cOpen(" + std::to_string(bus) + ", " + std::to_string(address) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cOpen(" + std::to_string(bus) + ", " + std::to_string(address) + ")");
     return 0;
 }
 
 void DummyIoProvider::i2cClose(unsigned int handle){
-    Logger::logDebugFrom("DummyIoProvider", "i2cClose(" + std::to_string(handle) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cClose(" + std::to_string(handle) + ")");
 }
 
 void DummyIoProvider::i2cWriteByte(unsigned int handle, uint8_t data){
-    Logger::logDebugFrom("DummyIoProvider", "i2cWriteByte(" + std::to_string(handle) + ", " + std::to_string(data) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cWriteByte(" + std::to_string(handle) + ", " + std::to_string(data) + ")");
 }
 
 uint8_t DummyIoProvider::i2cReadByte(unsigned int handle){
-    Logger::logDebugFrom("DummyIoProvider", "i2cReadByte(" + std::to_string(handle) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cReadByte(" + std::to_string(handle) + ")");
     return 0;
 }
 
 void DummyIoProvider::i2cWriteBytes(unsigned int handle, char *buf, unsigned int count){
-    Logger::logDebugFrom("DummyIoProvider", "i2cWriteBytes(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cWriteBytes(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
 }
 
 unsigned int DummyIoProvider::i2cReadBytes(unsigned int handle, char *buf, unsigned int count){
-    Logger::logDebugFrom("DummyIoProvider", "i2cReadBytes(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cReadBytes(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
     return 0;
 }
 
 void DummyIoProvider::i2cWriteReg8(unsigned int handle, uint8_t reg, uint8_t value){
-    Logger::logDebugFrom("DummyIoProvider", "i2cWriteReg8(" + std::to_string(handle) + ", " + std::to_string(reg) + ", " + std::to_string(value) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cWriteReg8(" + std::to_string(handle) + ", " + std::to_string(reg) + ", " + std::to_string(value) + ")");
 }
 
 uint8_t DummyIoProvider::i2cReadReg8(unsigned int handle, uint8_t reg){
-    Logger::logDebugFrom("DummyIoProvider", "i2cReadReg8(" + std::to_string(handle) + ", " + std::to_string(reg) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cReadReg8(" + std::to_string(handle) + ", " + std::to_string(reg) + ")");
     return 0;
 }
 
 void DummyIoProvider::i2cWriteReg16(unsigned int handle, uint8_t reg, uint16_t value){
-    Logger::logDebugFrom("DummyIoProvider", "i2cWriteReg16(" + std::to_string(handle) + ", " + std::to_string(reg) + ", " + std::to_string(value) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cWriteReg16(" + std::to_string(handle) + ", " + std::to_string(reg) + ", " + std::to_string(value) + ")");
 }
 
 uint16_t DummyIoProvider::i2cReadReg16(unsigned int handle, uint8_t reg){
-    Logger::logDebugFrom("DummyIoProvider", "i2cReadReg16(" + std::to_string(handle) + ", " + std::to_string(reg) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "i2cReadReg16(" + std::to_string(handle) + ", " + std::to_string(reg) + ")");
     return 0;
 }
 
@@ -119,20 +121,20 @@ uint16_t DummyIoProvider::i2cReadReg16(unsigned int handle, uint8_t reg){
 ////////////////////////////////////////////////////////////////////////
 
 unsigned int DummyIoProvider::spiOpen(unsigned int bus, unsigned int channel, unsigned int baud, unsigned int mode){
-    Logger::logDebugFrom("DummyIoProvider", "spiOpen(" + std::to_string(bus) + ", " + std::to_string(channel) + ", " + std::to_string(baud) + ", " + std::to_string(mode) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "spiOpen(" + std::to_string(bus) + ", " + std::to_string(channel) + ", " + std::to_string(baud) + ", " + std::to_string(mode) + ")");
     return 0;
 }
 
 void DummyIoProvider::spiClose(unsigned int handle){
-    Logger::logDebugFrom("DummyIoProvider", "spiClose(" + std::to_string(handle) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "spiClose(" + std::to_string(handle) + ")");
 }
 
 void DummyIoProvider::spiWrite(unsigned int handle, char *buf, unsigned int count){
-    Logger::logDebugFrom("DummyIoProvider", "spiWrite(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "spiWrite(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
 }
 
 unsigned int DummyIoProvider::spiRead(unsigned int handle, char *buf, unsigned int count){
-    Logger::logDebugFrom("DummyIoProvider", "spiRead(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "spiRead(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
     return 0;
 }
 
@@ -142,33 +144,45 @@ unsigned int DummyIoProvider::spiRead(unsigned int handle, char *buf, unsigned i
 ////////////////////////////////////////////////////////////////////////
 
 unsigned int DummyIoProvider::uartOpen(char *port, unsigned int baud){
-    Logger::logDebugFrom("DummyIoProvider", "uartOpen(" + std::string(port) + ", " + std::to_string(baud) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartOpen(" + std::string(port) + ", " + std::to_string(baud) + ")");
     return 0;
 }
 
 void DummyIoProvider::uartClose(unsigned int handle){
-    Logger::logDebugFrom("DummyIoProvider", "uartClose(" + std::to_string(handle) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartClose(" + std::to_string(handle) + ")");
 }
 
 unsigned int DummyIoProvider::uartAvailable(unsigned int handle){
-    Logger::logDebugFrom("DummyIoProvider", "uartAvailable(" + std::to_string(handle) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartAvailable(" + std::to_string(handle) + ")");
     return 0;
 }
 
 void DummyIoProvider::uartWrite(unsigned int handle, char* buf, unsigned int count){
-    Logger::logDebugFrom("DummyIoProvider", "uartWrite(" + std::to_string(handle) + ", buf, " + std::to_string(count)  + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartWrite(" + std::to_string(handle) + ", buf, " + std::to_string(count)  + ")");
+}
+
+void DummyIoProvider::uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount){
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartWritev(" + std::to_string(handle) + ", bufs, " + std::to_string(bufCount)  + ")");
 }
 
 unsigned int DummyIoProvider::uartRead(unsigned int handle, char *buf, unsigned int count){
-    Logger::logDebugFrom("DummyIoProvider", "uartRead(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartRead(" + std::to_string(handle) + ", buf, " + std::to_string(count) + ")");
+    return 0;
+}
+
+unsigned int DummyIoProvider::uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs){
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartReadTimeout(" + std::to_string(handle) + ", buf, " + std::to_string(count) + 
+        ", " + std::to_string(timeoutMs) + ")");
+    // Never any data. Wait so callers do not spin.
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
     return 0;
 }
 
 void DummyIoProvider::uartWriteByte(unsigned int handle, uint8_t b){
-    Logger::logDebugFrom("DummyIoProvider", "uartWriteByte(" + std::to_string(handle) + ", " + std::to_string(b) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartWriteByte(" + std::to_string(handle) + ", " + std::to_string(b) + ")");
 }
 
 uint8_t DummyIoProvider::uartReadByte(unsigned int handle){
-    Logger::logDebugFrom("DummyIoProvider", "uartReadByte(" + std::to_string(handle) + ")");
+    ARPIROBOT_LOG_DEBUG_FROM("DummyIoProvider", "uartReadByte(" + std::to_string(handle) + ")");
     return 0;
 }
@@ -328,6 +328,12 @@ void Io::uartWrite(unsigned int handle, char* buf, unsigned int count){
     }
 }
 
+void Io::uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount){
+    if(instance != nullptr){
+        instance->uartWritev(handle, bufs, bufCount);
+    }
+}
+
 unsigned int Io::uartRead(unsigned int handle, char *buf, unsigned int count){
     if(instance != nullptr){
         return instance->uartRead(handle, buf, count);
@@ -335,6 +341,13 @@ unsigned int Io::uartRead(unsigned int handle, char *buf, unsigned int count){
     return 0;
 }
 
+unsigned int Io::uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs){
+    if(instance != nullptr){
+        return instance->uartReadTimeout(handle, buf, count, timeoutMs);
+    }
+    return 0;
+}
+
 void Io::uartWriteByte(unsigned int handle, uint8_t b){
     if(instance != nullptr){
         instance->uartWriteByte(handle, b);
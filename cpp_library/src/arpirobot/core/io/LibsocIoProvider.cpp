@@ -380,6 +380,14 @@ void LibsocIoProvider::uartWrite(unsigned int handle, char* buf, unsigned int co
 #endif
 }
 
+void LibsocIoProvider::uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount){
+#ifdef HAS_SERIAL
+    uartProvider->uartWritev(handle, bufs, bufCount);
+#else
+    throw NotImplementedByProviderException();
+#endif
+}
+
 unsigned int LibsocIoProvider::uartRead(unsigned int handle, char *buf, unsigned int count){
 #ifdef HAS_SERIAL
     return uartProvider->uartRead(handle, buf, count);
@@ -388,6 +396,14 @@ unsigned int LibsocIoProvider::uartRead(unsigned int handle, char *buf, unsigned
 #endif
 }
 
+unsigned int LibsocIoProvider::uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs){
+#ifdef HAS_SERIAL
+    return uartProvider->uartReadTimeout(handle, buf, count, timeoutMs);
+#else
+    throw NotImplementedByProviderException();
+#endif
+}
+
 void LibsocIoProvider::uartWriteByte(unsigned int handle, uint8_t b){
 #ifdef HAS_SERIAL
     uartProvider->uartWriteByte(handle, b);
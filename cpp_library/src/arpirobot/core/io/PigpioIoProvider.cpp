@@ -26,6 +26,9 @@
 #include <arpirobot/core/io/exceptions.hpp>
 
 #include <pigpio.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 using namespace arpirobot;
 
@@ -210,6 +213,16 @@ void PigpioIoProvider::uartWrite(unsigned int handle, char* buf, unsigned int co
     handlePigpioError(res, true);
 }
 
+void PigpioIoProvider::uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount){
+    // pigpio has no vectored write. Join the buffers so they are still sent with one write.
+    static thread_local std::vector<char> joined;
+    joined.clear();
+    for(unsigned int i = 0; i < bufCount; ++i)
+        joined.insert(joined.end(), bufs[i].buf, bufs[i].buf + bufs[i].count);
+    int res = ::serWrite(handle, joined.data(), joined.size());
+    handlePigpioError(res, true);
+}
+
 unsigned int PigpioIoProvider::uartRead(unsigned int handle, char *buf, unsigned int count){
     int res = ::serRead(handle, buf, count);
     if(res == PI_SER_READ_NO_DATA) return 0;
@@ -217,6 +230,21 @@ unsigned int PigpioIoProvider::uartRead(unsigned int handle, char *buf, unsigned
     return res;
 }
 
+unsigned int PigpioIoProvider::uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs){
+    // pigpio does not expose the file descriptor of a serial handle, so it cannot be polled.
+    // Check for data every millisecond instead.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while(true){
+        int res = ::serDataAvailable(handle);
+        handlePigpioError(res, false);
+        if(res > 0)
+            return uartRead(handle, buf, std::min(count, (unsigned int)res));
+        if(std::chrono::steady_clock::now() >= deadline)
+            return 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
 void PigpioIoProvider::uartWriteByte(unsigned int handle, uint8_t b){
     int res = ::serWriteByte(handle, b);
     handlePigpioError(res, true);
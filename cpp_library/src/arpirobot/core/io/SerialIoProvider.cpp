@@ -21,11 +21,14 @@
 #include <arpirobot/core/io/SerialIoProvider.hpp>
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/io/exceptions.hpp>
+#include <algorithm>
 
 using namespace arpirobot;
 
 #ifdef HAS_SERIAL
 
+const uint32_t SerialIoProvider::WRITE_TIMEOUT_MS = 1000;
+
 SerialIoProvider::SerialIoProvider(bool disableWarn) : IoProvider(){
     if(!disableWarn){
         Logger::logWarning("The serial IO provider has been started. This provider CANNOT be used to " 
@@ -146,6 +149,9 @@ unsigned int SerialIoProvider::uartOpen(char *port, unsigned int baud){
         delete serial;
         throw OpenFailedException();
     }
+    // Reads do not wait (uartReadTimeout waits itself). Writes wait for room in the OS buffer.
+    serial::Timeout timeout(0, 0, 0, WRITE_TIMEOUT_MS, 0);
+    serial->setTimeout(timeout);
     int handle = currentHandle++;
     handleMap[handle] = serial;
     return handle;
@@ -170,19 +176,31 @@ unsigned int SerialIoProvider::uartAvailable(unsigned int handle){
 }
 
 void SerialIoProvider::uartWrite(unsigned int handle, char* buf, unsigned int count){
-    uint8_t *byteBuf = new uint8_t[count];
-    if(handleMap.find(handle) != handleMap.end()){
-        for(size_t i = 0; i < count; ++i){
-            byteBuf[i] = buf[i];
-        }
-        handleMap[handle]->write(byteBuf, count);
-        delete[] byteBuf;
+    auto it = handleMap.find(handle);
+    if(it != handleMap.end()){
+        writeAll(it->second, reinterpret_cast<const uint8_t*>(buf), count);
     }else{
-        delete[] byteBuf;
         throw BadHandleException();
     }
 }
 
+void SerialIoProvider::uartWritev(unsigned int handle, const UartBuffer *bufs, unsigned int bufCount){
+    auto it = handleMap.find(handle);
+    if(it == handleMap.end()){
+        throw BadHandleException();
+    }
+    if(bufCount == 1){
+        writeAll(it->second, reinterpret_cast<const uint8_t*>(bufs[0].buf), bufs[0].count);
+        return;
+    }
+    // serial::Serial has no vectored write. Join the buffers so they are still sent with one write.
+    static thread_local std::vector<uint8_t> joined;
+    joined.clear();
+    for(unsigned int i = 0; i < bufCount; ++i)
+        joined.insert(joined.end(), bufs[i].buf, bufs[i].buf + bufs[i].count);
+    writeAll(it->second, joined.data(), joined.size());
+}
+
 unsigned int SerialIoProvider::uartRead(unsigned int handle, char *buf, unsigned int count){
     uint8_t *byteBuf = new uint8_t[count];
     if(handleMap.find(handle) != handleMap.end()){
@@ -198,9 +216,32 @@ unsigned int SerialIoProvider::uartRead(unsigned int handle, char *buf, unsigned
     }
 }
 
+unsigned int SerialIoProvider::uartReadTimeout(unsigned int handle, char *buf, unsigned int count, unsigned int timeoutMs){
+    auto it = handleMap.find(handle);
+    if(it == handleMap.end()){
+        throw BadHandleException();
+    }
+    serial::Serial *serial = it->second;
+
+    // Only wait if nothing is buffered already. waitReadable blocks (select) for up to timeoutMs.
+    // The port's timeout settings are not changed, since writes from other threads use them.
+    size_t avail = serial->available();
+    if(avail == 0){
+        if(!serial->waitReadable(timeoutMs))
+            return 0;
+        avail = serial->available();
+    }
+
+    // Only read what is already buffered so the read does not wait
+    size_t toRead = std::min((size_t)count, avail);
+    if(toRead == 0)
+        return 0;
+    return serial->read(reinterpret_cast<uint8_t*>(buf), toRead);
+}
+
 void SerialIoProvider::uartWriteByte(unsigned int handle, uint8_t b){
     if(handleMap.find(handle) != handleMap.end()){
-        handleMap[handle]->write(&b, 1);
+        writeAll(handleMap[handle], &b, 1);
     }else{
         throw BadHandleException();
     }
@@ -216,5 +257,11 @@ uint8_t SerialIoProvider::uartReadByte(unsigned int handle){
     }
 }
 
+void SerialIoProvider::writeAll(serial::Serial *serial, const uint8_t *data, size_t count){
+    if(serial->write(data, count) != count){
+        throw WriteFailedException();
+    }
+}
+
 
 #endif // HAS_SERIAL
\ No newline at end of file
@@ -19,55 +19,285 @@
 
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/network/NetworkManager.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+#include <arpirobot/core/diag/FlightRecorder.hpp>
+#include <arpirobot/core/util/MpscQueue.hpp>
 #include <iostream>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdlib>
 
 using namespace arpirobot;
 
-std::mutex Logger::logMutex;
+
+struct Logger::State{
+    State(size_t queueSize) : queue(queueSize) { }
+
+    MpscQueue<std::string> queue;
+    std::thread thread;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    std::condition_variable flushCv;
+};
+
+std::once_flag Logger::startFlag;
+Logger::State *Logger::state = nullptr;
+std::atomic<bool> Logger::running {false};
+std::atomic<bool> Logger::sleeping {false};
+std::atomic<Logger::OverflowPolicy> Logger::overflowPolicy {Logger::OverflowPolicy::DROP_NEWEST};
+std::atomic<uint64_t> Logger::queuedCount {0};
+std::atomic<uint64_t> Logger::writtenCount {0};
+std::atomic<uint64_t> Logger::droppedCount {0};
+std::mutex Logger::directMutex;
+
+std::atomic<int> Logger::globalLevel {(int)Logger::Level::Debug};
+std::atomic<int> Logger::minLevel {(int)Logger::Level::Debug};
+std::atomic<size_t> Logger::sourceLevelCount {0};
+std::unordered_map<std::string, int> Logger::sourceLevels;
+std::mutex Logger::levelMutex;
 
 void Logger::logDebug(std::string message){
-    log("[DEBUG]: " + message);
+    if(isEnabled(Level::Debug))
+        write(Level::Debug, "", message);
 }
         
 void Logger::logInfo(std::string message){
-    log("[INFO]: " + message);
+    if(isEnabled(Level::Info))
+        write(Level::Info, "", message);
 }
 
 void Logger::logWarning(std::string message){
-    log("[WARNING]: " + message);
+    if(isEnabled(Level::Warning))
+        write(Level::Warning, "", message);
 }
 
 void Logger::logError(std::string message){
-    log("[ERROR]: " + message);
+    if(isEnabled(Level::Error))
+        write(Level::Error, "", message);
 }
 
 void Logger::logDebugFrom(std::string source, std::string message){
-    log("[DEBUG]: " + source + " - " + message);
+    if(isEnabled(Level::Debug, source))
+        write(Level::Debug, source, message);
 }
 
 void Logger::logInfoFrom(std::string source, std::string message){
-    log("[INFO]: " + source + " - " + message);
+    if(isEnabled(Level::Info, source))
+        write(Level::Info, source, message);
 }
 
 void Logger::logWarningFrom(std::string source, std::string message){
-    log("[WARNING]: " + source + " - " + message);
+    if(isEnabled(Level::Warning, source))
+        write(Level::Warning, source, message);
 }
 
 void Logger::logErrorFrom(std::string source, std::string message){
-    log("[ERROR]: " + source + " - " + message);
+    if(isEnabled(Level::Error, source))
+        write(Level::Error, source, message);
 }
 
 void Logger::logNewline(){
     log("");
 }
 
+void Logger::write(Level level, const std::string &source, const std::string &message){
+    std::string line;
+    switch(level){
+    case Level::Debug:
+        line = "[DEBUG]: ";
+        break;
+    case Level::Info:
+        line = "[INFO]: ";
+        break;
+    case Level::Warning:
+        line = "[WARNING]: ";
+        break;
+    default:
+        line = "[ERROR]: ";
+        break;
+    }
+    if(!source.empty()){
+        line += source;
+        line += " - ";
+    }
+    line += message;
+    log(std::move(line));
+}
+
+void Logger::setLevel(Level level){
+    std::lock_guard<std::mutex> l(levelMutex);
+    globalLevel = (int)level;
+    updateMinLevel();
+}
+
+Logger::Level Logger::getLevel(){
+    return (Level)globalLevel.load();
+}
+
+void Logger::setSourceLevel(const std::string &source, Level level){
+    std::lock_guard<std::mutex> l(levelMutex);
+    sourceLevels[source] = (int)level;
+    sourceLevelCount = sourceLevels.size();
+    updateMinLevel();
+}
+
+void Logger::clearSourceLevel(const std::string &source){
+    std::lock_guard<std::mutex> l(levelMutex);
+    sourceLevels.erase(source);
+    sourceLevelCount = sourceLevels.size();
+    updateMinLevel();
+}
+
+bool Logger::isEnabled(Level level, const std::string &source){
+    if(!anyEnabled(level))
+        return false;
+    if(sourceLevelCount == 0)
+        return isEnabled(level);
+    std::lock_guard<std::mutex> l(levelMutex);
+    auto it = sourceLevels.find(source);
+    if(it == sourceLevels.end())
+        return isEnabled(level);
+    return (int)level >= it->second;
+}
+
+void Logger::updateMinLevel(){
+    int level = globalLevel;
+    for(const auto &it : sourceLevels){
+        level = std::min(level, it.second);
+    }
+    minLevel = level;
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy){
+    overflowPolicy = policy;
+}
+
+uint64_t Logger::getDroppedCount(){
+    return droppedCount;
+}
+
+void Logger::flush(){
+    if(!running)
+        return;
+    uint64_t target = queuedCount;
+    std::unique_lock<std::mutex> l(state->wakeMutex);
+    state->wakeCv.notify_one();
+    state->flushCv.wait(l, [target](){ return writtenCount >= target || !running; });
+}
+
 void Logger::log(std::string message){
-    logMutex.lock();
-    try{
+    std::call_once(startFlag, &Logger::start);
+    FlightRecorder::recordLog(message);
+
+    if(!running){
+        // Background thread stopped (at exit). Write directly.
+        std::lock_guard<std::mutex> l(directMutex);
+        std::cout << message << std::endl;
+        return;
+    }
+
+    if(!state->queue.push(std::move(message))){
+        // The background thread can't wait for itself
+        if(overflowPolicy == OverflowPolicy::BLOCK && std::this_thread::get_id() != state->thread.get_id()){
+            do{
+                wake();
+                std::this_thread::yield();
+            }while(!state->queue.push(std::move(message)) && running);
+        }else{
+            droppedCount++;
+            return;
+        }
+    }
+    queuedCount++;
+
+    // Only take the lock if the background thread is (or is about to be) waiting.
+    // Fence pairs with the one in run so either this sees sleeping or run sees the message.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping)
+        wake();
+}
+
+void Logger::wake(){
+    std::lock_guard<std::mutex> l(state->wakeMutex);
+    state->wakeCv.notify_one();
+}
+
+void Logger::start(){
+    state = new State(std::max(RobotProfile::logQueueSize, 2));
+    running = true;
+    state->thread = std::thread(&Logger::run);
+    std::atexit(&Logger::stop);
+}
+
+void Logger::stop(){
+    {
+        std::lock_guard<std::mutex> l(state->wakeMutex);
+        running = false;
+        state->wakeCv.notify_one();
+        state->flushCv.notify_all();
+    }
+    state->thread.join();
+
+    // Anything logged while the thread was stopping
+    std::string message;
+    while(state->queue.pop(message)){
         std::cout << message << std::endl;
-        NetworkManager::sendLogMessage(message + "\n");
-    }catch(...){
+    }
+}
 
+void Logger::run(){
+    std::string message;
+    std::string batch;
+    uint64_t reportedDropped = 0;
+    while(true){
+        // Write everything queued in batches (one stdout write and flush per batch)
+        size_t count = 0;
+        batch.clear();
+        while(count < MAX_BATCH && state->queue.pop(message)){
+            message += '\n';
+            batch += message;
+            try{
+                NetworkManager::sendLogMessage(std::move(message));
+            }catch(...){
+
+            }
+            count++;
+        }
+
+        uint64_t dropped = droppedCount;
+        if(dropped != reportedDropped){
+            message = "[WARNING]: " + std::to_string(dropped - reportedDropped) + 
+                " log messages dropped (log queue full).\n";
+            batch += message;
+            try{
+                NetworkManager::sendLogMessage(std::move(message));
+            }catch(...){
+
+            }
+            reportedDropped = dropped;
+        }
+
+        if(!batch.empty()){
+            std::cout.write(batch.data(), batch.size());
+            std::cout.flush();
+        }
+        if(count > 0){
+            writtenCount += count;
+            std::lock_guard<std::mutex> l(state->wakeMutex);
+            state->flushCv.notify_all();
+            continue;
+        }
+
+        // Nothing queued. Wait for a message.
+        std::unique_lock<std::mutex> l(state->wakeMutex);
+        if(!running)
+            break;
+        sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        state->wakeCv.wait_for(l, std::chrono::milliseconds(100), [](){ 
+            return !state->queue.empty() || !running; 
+        });
+        sleeping = false;
     }
-    logMutex.unlock();
-}
\ No newline at end of file
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/network/ClockSync.hpp>
+#include <chrono>
+#include <cmath>
+
+
+using namespace arpirobot;
+
+
+std::mutex ClockSync::lock;
+ClockSync::Sample ClockSync::window[ClockSync::WINDOW_SIZE];
+int ClockSync::windowCount = 0;
+int ClockSync::windowNext = 0;
+bool ClockSync::synced = false;
+ClockSync::Sample ClockSync::best;
+ClockSync::Sample ClockSync::driftAnchor;
+double ClockSync::drift = 0;
+bool ClockSync::hasDrift = false;
+
+bool ClockSync::isSynced(){
+    std::lock_guard<std::mutex> l(lock);
+    return synced;
+}
+
+int64_t ClockSync::getOffsetUs(){
+    std::lock_guard<std::mutex> l(lock);
+    return offsetAt(robotTimeUs());
+}
+
+int64_t ClockSync::getRoundTripUs(){
+    std::lock_guard<std::mutex> l(lock);
+    return best.rtt;
+}
+
+int64_t ClockSync::getErrorBoundUs(){
+    std::lock_guard<std::mutex> l(lock);
+    if(!synced)
+        return 0;
+    // Uncertainty of the drift estimate is not known, so assume the error grows by the size of it
+    int64_t age = robotTimeUs() - best.robotTime;
+    return best.rtt / 2 + (int64_t)std::abs(drift * age);
+}
+
+double ClockSync::getDriftPpm(){
+    std::lock_guard<std::mutex> l(lock);
+    return drift * 1e6;
+}
+
+int64_t ClockSync::toRobotTime(int64_t dsTimeUs){
+    std::lock_guard<std::mutex> l(lock);
+    if(!synced)
+        return dsTimeUs;
+    // Offset changes slowly, so using the offset at the (approximate) robot time is accurate enough
+    return dsTimeUs - offsetAt(dsTimeUs - best.offset);
+}
+
+int64_t ClockSync::robotTimeUs(){
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string ClockSync::makePing(){
+    return "PING " + std::to_string(robotTimeUs()) + "\n";
+}
+
+void ClockSync::handlePong(int64_t t1, int64_t t2, int64_t t3, int64_t t4){
+    int64_t rtt = (t4 - t1) - (t3 - t2);
+    if(t4 < t1 || rtt < 0){
+        // Invalid (or not a reply to one of our pings)
+        return;
+    }
+
+    Sample sample;
+    sample.robotTime = t4;
+    sample.offset = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.rtt = rtt;
+
+    std::lock_guard<std::mutex> l(lock);
+    window[windowNext] = sample;
+    windowNext = (windowNext + 1) % WINDOW_SIZE;
+    if(windowCount < WINDOW_SIZE)
+        windowCount++;
+
+    // Best sample in the window is the one with the smallest round trip time
+    Sample newBest = window[0];
+    for(int i = 1; i < windowCount; ++i){
+        if(window[i].rtt < newBest.rtt)
+            newBest = window[i];
+    }
+    best = newBest;
+
+    if(!synced){
+        driftAnchor = best;
+        synced = true;
+    }else if(best.robotTime - driftAnchor.robotTime >= DRIFT_MIN_SPAN_US){
+        // Smooth the drift estimate. Each new estimate covers at least DRIFT_MIN_SPAN_US.
+        double newDrift = (double)(best.offset - driftAnchor.offset) / (best.robotTime - driftAnchor.robotTime);
+        drift = hasDrift ? drift + (newDrift - drift) / 4.0 : newDrift;
+        hasDrift = true;
+        driftAnchor = best;
+    }
+}
+
+void ClockSync::reset(){
+    std::lock_guard<std::mutex> l(lock);
+    windowCount = 0;
+    windowNext = 0;
+    synced = false;
+    best = Sample();
+    driftAnchor = Sample();
+    drift = 0;
+    hasDrift = false;
+}
+
+int64_t ClockSync::offsetAt(int64_t robotTime){
+    if(!synced)
+        return 0;
+    return best.offset + (int64_t)(drift * (robotTime - best.robotTime));
+}
@@ -20,7 +20,10 @@
 #include <arpirobot/core/network/ControllerData.hpp>
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/robot/BaseRobot.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+#include <arpirobot/core/network/ClockSync.hpp>
 #include <cmath>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 
@@ -102,3 +105,72 @@ void ControllerData::updateData(std::vector<uint8_t> &data){
     lastData = data;
     lastUpdateTime = std::chrono::steady_clock::now();
 }
+
+bool ControllerData::acceptPacket(uint32_t sequence, uint64_t sendTime){
+    std::lock_guard<std::mutex> l(lock);
+
+    int64_t nowUs = ClockSync::robotTimeUs();
+
+    // Transit time is meaningless by itself (different clocks), but differences between packets are not
+    int64_t transitUs = nowUs - (int64_t)sendTime;
+
+    if(linkStats.extended){
+        int32_t diff = (int32_t)(sequence - linkStats.lastSequence);
+        if(diff <= 0 && diff > -SEQUENCE_RESET_THRESHOLD){
+            linkStats.outOfOrder++;
+            return false;
+        }else if(diff > 1){
+            linkStats.lost += diff - 1;
+        }
+
+        // RFC 3550 interarrival jitter
+        double d = std::abs(transitUs - lastTransitUs) / 1000.0;
+        linkStats.jitterMs += (d - linkStats.jitterMs) / 16.0;
+
+        if(nowUs - transitWindowStartUs > TRANSIT_WINDOW_US){
+            prevMinTransitUs = minTransitUs;
+            minTransitUs = transitUs;
+            transitWindowStartUs = nowUs;
+        }else{
+            minTransitUs = std::min(minTransitUs, transitUs);
+        }
+    }else{
+        minTransitUs = transitUs;
+        prevMinTransitUs = transitUs;
+        transitWindowStartUs = nowUs;
+    }
+
+    linkStats.extended = true;
+    linkStats.lastSequence = sequence;
+    lastTransitUs = transitUs;
+    linkStats.relativeDelayMs = (transitUs - std::min(minTransitUs, prevMinTransitUs)) / 1000.0;
+
+    // Absolute latency is only known if the clocks are synchronized
+    linkStats.latencyValid = ClockSync::isSynced();
+    if(linkStats.latencyValid){
+        linkStats.latencyMs = (nowUs - ClockSync::toRobotTime(sendTime)) / 1000.0;
+    }
+
+    double delayMs = linkStats.latencyValid ? linkStats.latencyMs : linkStats.relativeDelayMs;
+    if(delayMs > RobotProfile::maxGamepadDataAge){
+        // Newer than anything used so far, but too old to use
+        linkStats.late++;
+        return false;
+    }
+    linkStats.received++;
+    return true;
+}
+
+void ControllerData::resetLink(){
+    std::lock_guard<std::mutex> l(lock);
+    linkStats = ControllerLinkStats();
+    lastTransitUs = 0;
+    minTransitUs = 0;
+    prevMinTransitUs = 0;
+    transitWindowStartUs = 0;
+}
+
+ControllerLinkStats ControllerData::getLinkStats(){
+    std::lock_guard<std::mutex> l(lock);
+    return linkStats;
+}
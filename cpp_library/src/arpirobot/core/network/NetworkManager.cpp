@@ -20,9 +20,16 @@
 #include <arpirobot/core/network/NetworkManager.hpp>
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/robot/BaseRobot.hpp>
+#include <arpirobot/core/util/Endian.hpp>
+#include <arpirobot/core/network/ClockSync.hpp>
+#include <arpirobot/core/diag/LatencyTracer.hpp>
+#include <arpirobot/core/diag/FlightRecorder.hpp>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <algorithm>
+#include <cstdio>
 
 
 using namespace arpirobot;
@@ -33,6 +40,11 @@ using namespace std::placeholders;
 const std::string arpirobot::COMMAND_ENABLE = "ENABLE";
 const std::string arpirobot::COMMAND_DISABLE = "DISABLE";
 const std::string arpirobot::COMMAND_NET_TABLE_SYNC = "NT_SYNC";
+const std::string arpirobot::COMMAND_CONTROLLER_EXT = "CTRL_EXT";
+const std::string arpirobot::COMMAND_CLOCK_SYNC = "CLOCK_SYNC";
+const std::string arpirobot::COMMAND_PONG = "PONG";
+
+const std::string arpirobot::NET_TABLE_CAPABILITIES_KEY = "capabilities";
 
 // Pre-defined (special) data packets
 const uint8_t arpirobot::NET_TABLE_START_SYNC_DATA[] = {255, 255, '\n'};
@@ -40,40 +52,112 @@ const std::string arpirobot::NET_TABLE_END_SYNC_DATA = "\377\377\377\n";
 
 // Static variables for NetworkManager
 std::thread *NetworkManager::networkThread = nullptr;
-bool NetworkManager::isDsConnected = false;
+std::atomic<bool> NetworkManager::isDsConnected {false};
+std::atomic<bool> NetworkManager::extendedControllerPackets {false};
 bool NetworkManager::networkingStarted = false;
-std::array<uint8_t, 32> NetworkManager::tmpCommandRxBuf;
-std::array<uint8_t, 32> NetworkManager::tmpNetTableRxBuf;
-std::array<uint8_t, 32> NetworkManager::tmpControllerRxBuf;
-std::vector<uint8_t> NetworkManager::commandRxData;
-std::vector<uint8_t> NetworkManager::netTableRxData;
+RingBuffer NetworkManager::commandRxBuffer(1024);
+RingBuffer NetworkManager::netTableRxBuffer(16 * 1024);
+std::array<uint8_t, 1024> NetworkManager::tmpControllerRxBuf;
 io_service NetworkManager::io;
 io_service::work NetworkManager::wk(NetworkManager::io);
-udp::socket NetworkManager::controllerSocket(NetworkManager::io, udp::endpoint(udp::v4(), 8090));
-tcp::acceptor NetworkManager::commandSocketAcceptor(NetworkManager::io, tcp::endpoint(tcp::v4(), 8091));
-tcp::acceptor NetworkManager::netTableSocketAcceptor(NetworkManager::io, tcp::endpoint(tcp::v4(), 8092));
-tcp::acceptor NetworkManager::logSocketAcceptor(NetworkManager::io, tcp::endpoint(tcp::v4(), 8093));
+udp::socket NetworkManager::controllerSocket(NetworkManager::io);
+tcp::acceptor NetworkManager::commandSocketAcceptor(NetworkManager::io);
+tcp::acceptor NetworkManager::netTableSocketAcceptor(NetworkManager::io);
+tcp::acceptor NetworkManager::logSocketAcceptor(NetworkManager::io);
 udp::endpoint NetworkManager::controllerDataEndpoint;
 tcp::socket NetworkManager::commandClient(NetworkManager::io);
 tcp::socket NetworkManager::netTableClient(NetworkManager::io);
 tcp::socket NetworkManager::logClient(NetworkManager::io);
+SendQueue NetworkManager::commandQueue(NetworkManager::io, 4 * 1024, SendQueue::OverflowPolicy::DROP_NEWEST);
+SendQueue NetworkManager::netTableQueue(NetworkManager::io, 256 * 1024, SendQueue::OverflowPolicy::DROP_OLDEST);
+SendQueue NetworkManager::logQueue(NetworkManager::io, 64 * 1024, SendQueue::OverflowPolicy::DROP_OLDEST);
+asio::steady_timer NetworkManager::clockSyncTimer(NetworkManager::io);
+int NetworkManager::clockSyncPings = 0;
+udp::socket NetworkManager::telemetrySocket(NetworkManager::io);
+udp::endpoint NetworkManager::telemetryEndpoint;
+std::vector<udp::endpoint> NetworkManager::subscriberTelemetryEndpoints;
+std::mutex NetworkManager::telemetryLock;
+tcp::acceptor NetworkManager::subscriberAcceptor(NetworkManager::io);
+std::vector<std::shared_ptr<NetworkManager::Subscriber>> NetworkManager::subscribers;
+std::vector<std::shared_ptr<NetworkManager::Subscriber>> NetworkManager::closedSubscribers;
+std::atomic<size_t> NetworkManager::subscriberCount {0};
+std::mutex NetworkManager::subscribersLock;
+const uint8_t NetworkManager::SUBSCRIBER_NT_TAG[] = {'N'};
+const uint8_t NetworkManager::SUBSCRIBER_LOG_TAG[] = {'L'};
 std::function<void()> NetworkManager::enableFunc = nullptr;
 std::function<void()> NetworkManager::disableFunc = nullptr;
 std::unordered_map<std::string, std::string> NetworkManager::ntSyncData;
 std::unordered_map<int, std::shared_ptr<ControllerData>> NetworkManager::controllerData;
 MainVmon *NetworkManager::mainVmon = nullptr;
+HandlerStats NetworkManager::controllerHandlerStats;
+HandlerStats NetworkManager::netTableHandlerStats;
+HandlerStats NetworkManager::commandHandlerStats;
+
+NetworkManager::Subscriber::Subscriber(io_service &io, size_t maxBytes) : 
+        socket(io), queue(io, maxBytes, SendQueue::OverflowPolicy::DROP_OLDEST){
+
+}
 
 void NetworkManager::startNetworking(std::function<void()> enableFunc, std::function<void()> disableFunc){
     if(!networkingStarted){
         if(networkThread != nullptr){
             networkThread->join();
             delete networkThread;
+            networkThread = nullptr;
         }
 
         // Store enable and disable function "pointers"
         NetworkManager::enableFunc = enableFunc;
         NetworkManager::disableFunc = disableFunc;
 
+        netTableQueue.setMaxBytes(RobotProfile::netTableSendBufferSize);
+        logQueue.setMaxBytes(RobotProfile::logSendBufferSize);
+
+        // Sockets are created here (not when the library is loaded) so ports are only
+        // bound by programs that run a robot, and so RobotProfile can change them first
+        std::error_code ec;
+        asio::ip::address bindAddress = asio::ip::make_address(RobotProfile::networkBindAddress, ec);
+        if(ec){
+            Logger::logError("Invalid network bind address \"" + RobotProfile::networkBindAddress + 
+                "\". Listening on all interfaces.");
+            bindAddress = asio::ip::address_v4::any();
+        }
+
+        controllerSocket.open(udp::endpoint(bindAddress, 0).protocol(), ec);
+        if(!ec) controllerSocket.bind(udp::endpoint(bindAddress, RobotProfile::controllerPort), ec);
+        if(ec){
+            Logger::logError("Unable to receive controller data on port " + 
+                std::to_string(RobotProfile::controllerPort) + ": " + ec.message());
+            controllerSocket.close(ec);
+        }
+
+        listen(commandSocketAcceptor, tcp::endpoint(bindAddress, RobotProfile::commandPort), ec);
+        if(ec){
+            Logger::logError("Unable to listen for drive station on port " + 
+                std::to_string(RobotProfile::commandPort) + ": " + ec.message());
+        }
+        listen(netTableSocketAcceptor, tcp::endpoint(bindAddress, RobotProfile::netTablePort), ec);
+        if(ec){
+            Logger::logError("Unable to listen for drive station on port " + 
+                std::to_string(RobotProfile::netTablePort) + ": " + ec.message());
+        }
+        listen(logSocketAcceptor, tcp::endpoint(bindAddress, RobotProfile::logPort), ec);
+        if(ec){
+            Logger::logError("Unable to listen for drive station on port " + 
+                std::to_string(RobotProfile::logPort) + ": " + ec.message());
+        }
+
+        {
+            std::lock_guard<std::mutex> l(telemetryLock);
+            telemetrySocket.open(udp::endpoint(bindAddress, 0).protocol(), ec);
+            if(!ec) telemetrySocket.bind(udp::endpoint(bindAddress, 0), ec);
+            if(!ec) telemetrySocket.non_blocking(true, ec);
+            if(ec){
+                Logger::logWarning("Unable to open telemetry socket: " + ec.message());
+                telemetrySocket.close(ec);
+            }
+        }
+
         // Wait for connection from drive station
         commandSocketAcceptor.async_accept(commandClient, std::bind(&NetworkManager::handleAccept, 
             std::ref(commandClient), _1));
@@ -82,56 +166,303 @@ void NetworkManager::startNetworking(std::function<void()> enableFunc, std::func
         logSocketAcceptor.async_accept(logClient, std::bind(&NetworkManager::handleAccept, 
             std::ref(logClient), _1));
 
+        // Subscribers are optional. Networking with the DS still works if the port is not available.
+        if(RobotProfile::maxSubscribers > 0){
+            listen(subscriberAcceptor, tcp::endpoint(bindAddress, RobotProfile::subscriberPort), ec);
+            if(ec){
+                Logger::logWarning("Unable to listen for subscribers on port " + 
+                    std::to_string(RobotProfile::subscriberPort) + ": " + ec.message());
+            }else{
+                acceptSubscriber();
+            }
+        }
+
+        NetworkTable::set(NET_TABLE_CAPABILITIES_KEY, COMMAND_CONTROLLER_EXT + " " + COMMAND_CLOCK_SYNC);
+
+        // io_service may have been stopped by a previous stopNetworking
+        io.restart();
         networkThread = new std::thread(&NetworkManager::runNetworking);
+        networkingStarted = true;
 
-        Logger::logDebug("Starting Networking");
+        ARPIROBOT_LOG_DEBUG("Starting Networking");
     }
 }
 
 void NetworkManager::stopNetworking(){
+    if(!networkingStarted)
+        return;
+
     io.stop();
-    while(!io.stopped());
+    if(networkThread != nullptr){
+        networkThread->join();
+        delete networkThread;
+        networkThread = nullptr;
+    }
+
+    // Robot is stopping. Don't call back into it while closing the connection.
     enableFunc = nullptr;
     disableFunc = nullptr;
+
+    std::error_code ec;
+    commandClient.close(ec);
+    netTableClient.close(ec);
+    logClient.close(ec);
+    handleConnectionStatusChanged();
+
+    commandSocketAcceptor.close(ec);
+    netTableSocketAcceptor.close(ec);
+    logSocketAcceptor.close(ec);
+    controllerSocket.close(ec);
+    subscriberAcceptor.close(ec);
+    clockSyncTimer.cancel(ec);
+
+    {
+        std::lock_guard<std::mutex> l(subscribersLock);
+        for(auto &subscriber : subscribers){
+            subscriber->queue.stop();
+            subscriber->socket.close(ec);
+            closedSubscribers.push_back(subscriber);
+        }
+        subscribers.clear();
+        subscriberCount = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> l(telemetryLock);
+        telemetrySocket.close(ec);
+        subscriberTelemetryEndpoints.clear();
+    }
+
+    // Run handlers for the operations cancelled above so nothing left in the io_service
+    // refers to a closed client or subscriber if networking is started again
+    io.restart();
+    io.poll();
+    closedSubscribers.clear();
+
+    networkingStarted = false;
+}
+
+void NetworkManager::listen(tcp::acceptor &acceptor, const tcp::endpoint &endpoint, std::error_code &ec){
+    std::error_code ec2;
+    acceptor.open(endpoint.protocol(), ec);
+    if(!ec) acceptor.set_option(tcp::acceptor::reuse_address(true), ec);
+    if(!ec) acceptor.bind(endpoint, ec);
+    if(!ec) acceptor.listen(socket_base::max_listen_connections, ec);
+    if(ec) acceptor.close(ec2);
+}
+
+SendQueueStats NetworkManager::getNetTableSendStats(){
+    return netTableQueue.getStats();
+}
+
+SendQueueStats NetworkManager::getLogSendStats(){
+    return logQueue.getStats();
+}
+
+HandlerStats &NetworkManager::getControllerHandlerStats(){
+    return controllerHandlerStats;
+}
+
+HandlerStats &NetworkManager::getNetTableHandlerStats(){
+    return netTableHandlerStats;
+}
+
+HandlerStats &NetworkManager::getCommandHandlerStats(){
+    return commandHandlerStats;
 }
 
-bool NetworkManager::sendNtRaw(const_buffer buffer){
+size_t NetworkManager::getSubscriberCount(){
+    return subscriberCount;
+}
+
+std::vector<SendQueueStats> NetworkManager::getSubscriberSendStats(){
+    std::lock_guard<std::mutex> l(subscribersLock);
+    std::vector<SendQueueStats> stats;
+    for(auto &subscriber : subscribers){
+        stats.push_back(subscriber->queue.getStats());
+    }
+    return stats;
+}
+
+bool NetworkManager::sendNtRaw(const_buffer buffer, bool droppable){
     if(isDsConnected){
-        try{
-            asio::write(netTableClient, buffer);
-            return true;
-        }catch(const std::system_error &err){
-            if(err.code() == asio::error::eof || err.code() == asio::error::connection_reset){
-                handleDisconnect(netTableClient);
-            }
-            return false;
-        }
+        auto frame = std::make_shared<std::string>((const char*)buffer.data(), buffer.size());
+        return netTableQueue.enqueue(frame, "", droppable);
     }
     return false;
 }
 
-bool NetworkManager::sendNt(std::string key, std::string value){
-    std::vector<uint8_t> data;
-    for(size_t i = 0; i < key.length(); ++i){
-        data.push_back(key[i]);
+bool NetworkManager::sendNt(const std::string &key, const std::string &value, bool droppable){
+    if(!isDsConnected && subscriberCount == 0)
+        return false;
+
+    // Encoded once. The same frame is shared by all queues.
+    auto frame = makeNtFrame(key, value);
+    sendToSubscribers(frame, key, asio::buffer(SUBSCRIBER_NT_TAG));
+    if(isDsConnected){
+        return netTableQueue.enqueue(frame, key, droppable);
     }
-    data.push_back(255);
-    for(size_t i = 0; i < value.length(); ++i){
-        data.push_back(value[i]);
+    return false;
+}
+
+bool NetworkManager::sendNtSync(const std::string &key, const std::string &value){
+    if(isDsConnected){
+        return netTableQueue.enqueue(makeNtFrame(key, value), key, false);
     }
-    data.push_back('\n');
-    return sendNtRaw(asio::buffer(data));
+    return false;
+}
+
+void NetworkManager::sendNtToSubscribers(const std::string &key, const std::string &value){
+    if(subscriberCount > 0){
+        sendToSubscribers(makeNtFrame(key, value), key, asio::buffer(SUBSCRIBER_NT_TAG));
+    }
+}
+
+std::shared_ptr<const std::string> NetworkManager::makeNtFrame(const std::string &key, const std::string &value){
+    auto frame = std::make_shared<std::string>();
+    frame->reserve(key.length() + value.length() + 2);
+    frame->append(key);
+    frame->push_back((char)255);
+    frame->append(value);
+    frame->push_back('\n');
+    return frame;
 }
 
 void NetworkManager::sendLogMessage(std::string message){
-    if(isDsConnected){
-        try{
-            asio::write(logClient, asio::buffer(message));
-        }catch(const std::system_error &err){
-            if(err.code() == asio::error::eof || err.code() == asio::error::connection_reset){
-                handleDisconnect(logClient);
+    if(isDsConnected || subscriberCount > 0){
+        auto frame = std::make_shared<const std::string>(std::move(message));
+        sendToSubscribers(frame, "", asio::buffer(SUBSCRIBER_LOG_TAG));
+        if(isDsConnected){
+            logQueue.enqueue(frame);
+        }
+    }
+}
+
+void NetworkManager::sendToSubscribers(const std::shared_ptr<const std::string> &frame, 
+        const std::string &key, const_buffer tag){
+    if(subscriberCount == 0)
+        return;
+    std::lock_guard<std::mutex> l(subscribersLock);
+    for(auto &subscriber : subscribers){
+        // Full queues drop old data. Never blocks.
+        subscriber->queue.enqueue(frame, key, true, tag);
+    }
+}
+
+void NetworkManager::acceptSubscriber(){
+    auto subscriber = std::make_shared<Subscriber>(io, RobotProfile::subscriberSendBufferSize);
+    subscriberAcceptor.async_accept(subscriber->socket, 
+        std::bind(&NetworkManager::handleSubscriberAccept, subscriber, _1));
+}
+
+void NetworkManager::handleSubscriberAccept(std::shared_ptr<Subscriber> subscriber, const std::error_code &ec){
+    if(ec){
+        if(ec != asio::error::operation_aborted){
+            Logger::logWarning("Error accepting subscriber: " + ec.message());
+        }
+        return;
+    }
+
+    std::error_code ec2;
+    tcp::endpoint remote = subscriber->socket.remote_endpoint(ec2);
+    if(ec2){
+        subscriber->socket.close(ec2);
+        acceptSubscriber();
+        return;
+    }
+
+    bool accepted = false;
+    {
+        // Net table lock is held while adding the subscriber and queueing the snapshot so 
+        // that no change can be queued before the (older) snapshot value of the same key
+        std::lock_guard<std::mutex> ntl(NetworkTable::lock);
+        std::lock_guard<std::mutex> l(subscribersLock);
+        if(subscribers.size() < (size_t)RobotProfile::maxSubscribers){
+            // The queue belongs to the subscriber, so its error handler must not keep the subscriber alive
+            std::weak_ptr<Subscriber> weakSubscriber = subscriber;
+            subscriber->queue.start(&subscriber->socket, [weakSubscriber](const std::error_code&){
+                auto subscriber = weakSubscriber.lock();
+                if(subscriber != nullptr)
+                    removeSubscriber(subscriber);
+            });
+            for(const auto &it : *NetworkTable::data){
+                subscriber->queue.enqueue(makeNtFrame(it.first, it.second.value), it.first, true, 
+                    asio::buffer(SUBSCRIBER_NT_TAG));
             }
+            subscribers.push_back(subscriber);
+            subscriberCount = subscribers.size();
+            accepted = true;
+        }
+    }
+
+    if(accepted){
+        subscriber->telemetryEndpoint = udp::endpoint(remote.address(), RobotProfile::telemetryPort);
+        {
+            std::lock_guard<std::mutex> l(telemetryLock);
+            subscriberTelemetryEndpoints.push_back(subscriber->telemetryEndpoint);
         }
+        Logger::logInfo("Subscriber connected from " + remote.address().to_string() + ".");
+
+        // Only used to detect disconnect
+        subscriber->socket.async_receive(asio::buffer(subscriber->rxBuf), 
+            std::bind(&NetworkManager::handleSubscriberReceive, subscriber, _1, _2));
+    }else{
+        Logger::logWarning("Rejected subscriber from " + remote.address().to_string() + 
+            ". Too many subscribers.");
+        subscriber->socket.close(ec2);
+    }
+
+    acceptSubscriber();
+}
+
+void NetworkManager::handleSubscriberReceive(std::shared_ptr<Subscriber> subscriber, 
+        const std::error_code &ec, std::size_t count){
+    if(!ec){
+        // Data from subscribers is ignored
+        subscriber->socket.async_receive(asio::buffer(subscriber->rxBuf), 
+            std::bind(&NetworkManager::handleSubscriberReceive, subscriber, _1, _2));
+    }else if(ec != asio::error::operation_aborted){
+        removeSubscriber(subscriber);
+    }
+}
+
+void NetworkManager::removeSubscriber(std::shared_ptr<Subscriber> subscriber){
+    {
+        std::lock_guard<std::mutex> l(subscribersLock);
+        auto it = std::find(subscribers.begin(), subscribers.end(), subscriber);
+        if(it == subscribers.end())
+            return; // Already removed
+        subscribers.erase(it);
+        subscriberCount = subscribers.size();
+        closedSubscribers.push_back(subscriber);
+    }
+    {
+        std::lock_guard<std::mutex> l(telemetryLock);
+        auto it = std::find(subscriberTelemetryEndpoints.begin(), subscriberTelemetryEndpoints.end(), 
+            subscriber->telemetryEndpoint);
+        if(it != subscriberTelemetryEndpoints.end())
+            subscriberTelemetryEndpoints.erase(it);
+    }
+    subscriber->queue.stop();
+    std::error_code ec;
+    subscriber->socket.close(ec);
+    Logger::logInfo("Subscriber disconnected.");
+
+    // Pending write handlers run (aborted) before this
+    io.post(&NetworkManager::reapSubscribers);
+}
+
+void NetworkManager::reapSubscribers(){
+    std::lock_guard<std::mutex> l(subscribersLock);
+    for(auto it = closedSubscribers.begin(); it != closedSubscribers.end();){
+        if((*it)->queue.idle()){
+            it = closedSubscribers.erase(it);
+        }else{
+            ++it;
+        }
+    }
+    if(!closedSubscribers.empty()){
+        io.post(&NetworkManager::reapSubscribers);
     }
 }
 
@@ -154,11 +485,12 @@ void NetworkManager::runNetworking(){
 }
 
 void NetworkManager::receiveFrom(const tcp::socket &client){
+    // Receive as much data as is available directly into the ring buffers
     if(&client == &commandClient){
-        commandClient.async_receive(asio::buffer(tmpCommandRxBuf), 
+        commandClient.async_receive(commandRxBuffer.prepare(RX_READ_SIZE), 
             std::bind(&NetworkManager::handleTcpReceive, std::ref(commandClient), _1, _2));
     }else if(&client == &netTableClient){
-        netTableClient.async_receive(asio::buffer(tmpNetTableRxBuf), 
+        netTableClient.async_receive(netTableRxBuffer.prepare(RX_READ_SIZE), 
             std::bind(&NetworkManager::handleTcpReceive, std::ref(netTableClient), _1, _2));
     }
     // Data will never be received from log client
@@ -172,12 +504,25 @@ void NetworkManager::handleConnectionStatusChanged(){
         std::string logAddress = logClient.remote_endpoint().address().to_string();
         if(cmdAddress == netTableAddress && cmdAddress == logAddress){
             // Same address, valid DS
+            {
+                std::lock_guard<std::mutex> l(telemetryLock);
+                telemetryEndpoint = udp::endpoint(commandClient.remote_endpoint().address(), 
+                    RobotProfile::telemetryPort);
+            }
+            commandQueue.start(&commandClient, std::bind(&NetworkManager::handleWriteError, 
+                std::ref(commandClient), _1));
+            netTableQueue.start(&netTableClient, std::bind(&NetworkManager::handleWriteError, 
+                std::ref(netTableClient), _1));
+            logQueue.start(&logClient, std::bind(&NetworkManager::handleWriteError, 
+                std::ref(logClient), _1));
             isDsConnected = true;
             Logger::logInfo("Drive station connected.");
             
             // Start waiting for controller data
-            controllerSocket.async_receive_from(asio::buffer(tmpControllerRxBuf), 
-                controllerDataEndpoint, std::bind(&NetworkManager::handleUdpReceive, _1, _2));
+            if(controllerSocket.is_open()){
+                controllerSocket.async_receive_from(asio::buffer(tmpControllerRxBuf), 
+                    controllerDataEndpoint, std::bind(&NetworkManager::handleUdpReceive, _1, _2));
+            }
 
         }else{
             // Multiple DS connections. Reject all
@@ -193,16 +538,30 @@ void NetworkManager::handleConnectionStatusChanged(){
 
         if(NetworkTable::isInSync()){
             NetworkTable::abortSync();
-            Logger::logDebug("Net table sync aborted due to drive station disconnect.");
+            ARPIROBOT_LOG_DEBUG("Net table sync aborted due to drive station disconnect.");
         }
 
-        // Clear read buffers
-        netTableRxData.clear();
-        commandRxData.clear();
+        // Clear read buffers and drop any data not yet sent
+        netTableRxBuffer.clear();
+        commandRxBuffer.clear();
+        commandQueue.stop();
+        netTableQueue.stop();
+        logQueue.stop();
+
+        std::error_code ec;
+        clockSyncTimer.cancel(ec);
+        ClockSync::reset();
+
+        // Next DS may not send extended controller packets (or may restart sequence numbers)
+        extendedControllerPackets = false;
+        for(auto &it : controllerData){
+            it.second->resetLink();
+        }
 
         isDsConnected = false;
 
-        disableFunc();
+        if(disableFunc != nullptr)
+            disableFunc();
     }
 }
 
@@ -228,26 +587,38 @@ void NetworkManager::handleDisconnect(const tcp::socket &client){
 
 }
 
+void NetworkManager::handleWriteError(const tcp::socket &client, const std::error_code &ec){
+    if(client.is_open()){
+        handleDisconnect(client);
+    }
+}
+
 void NetworkManager::handleTcpReceive(const tcp::socket &client, 
         const std::error_code &ec, std::size_t count){
     if(!ec){
         if(count > 0 && isDsConnected){
             if(&client == &commandClient){
-                for(int i = 0; i < count; ++i){
-                    commandRxData.push_back(tmpCommandRxBuf[i]);
-                }
-                handleCommand();
+                HandlerTimer timer(commandHandlerStats);
+                commandRxBuffer.commit(count);
+                timer.setItems(handleCommand());
             }else if(&client == &netTableClient){
-                for(int i = 0; i < count; ++i){
-                    netTableRxData.push_back(tmpNetTableRxBuf[i]);
-                }
-                handleNetTableData();
+                HandlerTimer timer(netTableHandlerStats);
+                netTableRxBuffer.commit(count);
+                timer.setItems(handleNetTableData());
             }
         }
 
         // Wait for more data
-        if(isDsConnected)
+        if(isDsConnected){
+            if(&client == &commandClient && commandRxBuffer.full()){
+                Logger::logWarning("Command receive buffer full. Discarding received data.");
+                commandRxBuffer.clear();
+            }else if(&client == &netTableClient && netTableRxBuffer.full()){
+                Logger::logWarning("Net table receive buffer full. Discarding received data.");
+                netTableRxBuffer.clear();
+            }
             receiveFrom(client);
+        }
     }else if(ec == asio::error::eof || ec == asio::error::connection_reset){
         handleDisconnect(client);
     }
@@ -256,6 +627,8 @@ void NetworkManager::handleTcpReceive(const tcp::socket &client,
 void NetworkManager::handleUdpReceive(const std::error_code &ec, std::size_t count){
     bool shouldProcess = netTableClient.is_open() && commandClient.is_open() && logClient.is_open();
     if(!ec && shouldProcess){
+        auto arrivalTime = std::chrono::steady_clock::now();
+        HandlerTimer timer(controllerHandlerStats);
         std::string controllerAddress = controllerDataEndpoint.address().to_string();
         std::string commandAddress = commandClient.remote_endpoint().address().to_string();
         if(controllerAddress == commandAddress){
@@ -264,86 +637,160 @@ void NetworkManager::handleUdpReceive(const std::error_code &ec, std::size_t cou
             for(size_t i = 0; i < count; ++i){
                 data.push_back(tmpControllerRxBuf[i]);
             }
-            handleControllerData(data);
+            handleControllerData(data, arrivalTime);
         }
     }
-    if(shouldProcess){
+    if(shouldProcess && controllerSocket.is_open()){
         controllerSocket.async_receive_from(asio::buffer(tmpControllerRxBuf), 
             controllerDataEndpoint, std::bind(&NetworkManager::handleUdpReceive, _1, _2));
     }
 }
 
-void NetworkManager::handleCommand(){
-
-    auto startPos = commandRxData.begin();
-    auto endPos = startPos - 1;
-
+size_t NetworkManager::handleCommand(){
     // Could be multiple commands in the buffer, so handle all of them
-    while(true){
-        // End of last command is start of next
-        startPos = endPos + 1;
-        endPos = std::find(startPos, commandRxData.end(), '\n');
-        if(endPos == commandRxData.end()){
-            // Leave any incomplete data in the buffer
-            commandRxData = std::vector<uint8_t>(startPos, commandRxData.end());
-            break;
-        }
-
+    // Any incomplete command is left in the buffer
+    size_t handled = 0;
+    size_t endPos;
+    while((endPos = commandRxBuffer.find('\n')) != RingBuffer::npos){
         // Command excluding \n
-        std::string subset = std::string(startPos, endPos);
+        const char *cmd = (const char*)commandRxBuffer.peek(endPos);
+        size_t len = endPos;
         
         // Handle the command
-        if(subset == COMMAND_ENABLE){
-            Logger::logDebug("Got enable command");
+        if(bufferEquals(cmd, len, COMMAND_ENABLE)){
+            ARPIROBOT_LOG_DEBUG("Got enable command");
             if(enableFunc != nullptr)
                 enableFunc();
-        }else if(subset == COMMAND_DISABLE){
-            Logger::logDebug("Got disable command");
+        }else if(bufferEquals(cmd, len, COMMAND_DISABLE)){
+            ARPIROBOT_LOG_DEBUG("Got disable command");
             if(disableFunc != nullptr)
                 disableFunc();
-        }else if(subset == COMMAND_NET_TABLE_SYNC){
-            Logger::logDebug("Starting net table sync.");
+        }else if(bufferEquals(cmd, len, COMMAND_NET_TABLE_SYNC)){
+            ARPIROBOT_LOG_DEBUG("Starting net table sync.");
             ntSyncData.clear();
             NetworkTable::startSync();
+        }else if(bufferEquals(cmd, len, COMMAND_CONTROLLER_EXT)){
+            ARPIROBOT_LOG_DEBUG("Drive station is sending extended controller packets.");
+            extendedControllerPackets = true;
+        }else if(bufferEquals(cmd, len, COMMAND_CLOCK_SYNC)){
+            ARPIROBOT_LOG_DEBUG("Starting clock sync.");
+            clockSyncPings = 0;
+            sendClockSyncPing(std::error_code());
+        }else if(len > COMMAND_PONG.length() && bufferEquals(cmd, COMMAND_PONG.length() + 1, COMMAND_PONG + " ")){
+            // "PONG t1 t2 t3"
+            int64_t t4 = ClockSync::robotTimeUs();
+            long long t1, t2, t3;
+            std::string args(cmd + COMMAND_PONG.length() + 1, len - COMMAND_PONG.length() - 1);
+            if(sscanf(args.c_str(), "%lld %lld %lld", &t1, &t2, &t3) == 3){
+                ClockSync::handlePong(t1, t2, t3, t4);
+            }
+        }else if(len > COMMAND_NET_TABLE_SYNC.length() && 
+                bufferEquals(cmd, COMMAND_NET_TABLE_SYNC.length() + 1, COMMAND_NET_TABLE_SYNC + " ")){
+            // Versioned sync: "NT_SYNC epoch:version" (epoch and version from DS's last sync, or 0:0)
+            uint32_t sinceEpoch = 0;
+            uint64_t sinceVersion = 0;
+            std::string args(cmd + COMMAND_NET_TABLE_SYNC.length() + 1, len - COMMAND_NET_TABLE_SYNC.length() - 1);
+            auto sep = args.find(':');
+            if(sep != std::string::npos){
+                try{
+                    sinceEpoch = std::stoul(args.substr(0, sep));
+                    sinceVersion = std::stoull(args.substr(sep + 1));
+                }catch(const std::exception &e){
+                    // Malformed. Full sync.
+                    sinceEpoch = 0;
+                    sinceVersion = 0;
+                }
+            }
+            ARPIROBOT_LOG_DEBUG("Starting versioned net table sync.");
+            ntSyncData.clear();
+            NetworkTable::startSync(sinceEpoch, sinceVersion, true);
         }
+
+        commandRxBuffer.consume(endPos + 1);
+        handled++;
     }
+    return handled;
 }
 
-void NetworkManager::handleNetTableData(){
-    auto startPos = netTableRxData.begin();
-    auto endPos = startPos - 1;
-
+size_t NetworkManager::handleNetTableData(){
     // Data can be split across multiple packets or multiple keys could be in one packet.
     // Handle any data in the buffer and leave what is not handled
-    while(true){
-        startPos = endPos + 1;
-        endPos = std::find(startPos, netTableRxData.end(), '\n');
-        if(endPos == netTableRxData.end()){
-            // Leave any incomplete data in the buffer
-            netTableRxData = std::vector<uint8_t>(startPos, netTableRxData.end());
-            break;
-        }
-
-        // Subset until and including \n
-        std::string subset = std::string(startPos, endPos + 1);
-
-        // Handle data in the subset
-        auto delim = subset.find((char)255);
-        if(subset == NET_TABLE_END_SYNC_DATA){
+    size_t handled = 0;
+    size_t endPos;
+    while((endPos = netTableRxBuffer.find('\n')) != RingBuffer::npos){
+        // Line including \n
+        size_t len = endPos + 1;
+        const char *line = (const char*)netTableRxBuffer.peek(len);
+
+        // Handle data in the line (key and value are passed as pointers into the buffer)
+        const char *delim = (const char*)memchr(line, 255, endPos);
+        if(bufferEquals(line, len, NET_TABLE_END_SYNC_DATA)){
             NetworkTable::finishSync(ntSyncData);
-        }else if (delim != std::string::npos){
-            std::string key = std::string(subset.begin(), subset.begin() + delim);
-            std::string value = std::string(subset.begin() + delim + 1, subset.begin() + subset.length() - 1);
+        }else if (delim != nullptr){
+            size_t keyLen = delim - line;
+            const char *value = delim + 1;
+            size_t valueLen = endPos - keyLen - 1;
             if(NetworkTable::isInSync()){
-                ntSyncData[key] = value;
+                ntSyncData[std::string(line, keyLen)].assign(value, valueLen);
             }else{
-                NetworkTable::setFromDs(key, value);
+                NetworkTable::setFromDs(line, keyLen, value, valueLen);
             }
         }
+
+        netTableRxBuffer.consume(len);
+        handled++;
     }
+    return handled;
+}
+
+bool NetworkManager::bufferEquals(const char *buf, size_t len, const std::string &str){
+    return len == str.length() && memcmp(buf, str.data(), len) == 0;
 }
 
-void NetworkManager::handleControllerData(std::vector<uint8_t> &data){
+void NetworkManager::sendClockSyncPing(const std::error_code &ec){
+    if(ec || !isDsConnected)
+        return;
+    commandQueue.enqueue(std::make_shared<const std::string>(ClockSync::makePing()));
+
+    // Ping quickly at first to get a good estimate quickly
+    clockSyncPings++;
+    int period = clockSyncPings < 8 ? std::min(100, RobotProfile::clockSyncPeriod) : RobotProfile::clockSyncPeriod;
+    clockSyncTimer.expires_after(std::chrono::milliseconds(std::max(period, 1)));
+    clockSyncTimer.async_wait(&NetworkManager::sendClockSyncPing);
+}
+
+bool NetworkManager::hasTelemetryClients(){
+    return isDsConnected || subscriberCount > 0;
+}
+
+bool NetworkManager::sendTelemetry(const std::vector<uint8_t> &data){
+    std::lock_guard<std::mutex> l(telemetryLock);
+    bool sent = false;
+    std::error_code ec;
+    if(isDsConnected){
+        telemetrySocket.send_to(asio::buffer(data), telemetryEndpoint, 0, ec);
+        sent = !ec;
+    }
+    for(const auto &endpoint : subscriberTelemetryEndpoints){
+        telemetrySocket.send_to(asio::buffer(data), endpoint, 0, ec);
+        sent = sent || !ec;
+    }
+    return sent;
+}
+
+void NetworkManager::handleControllerData(std::vector<uint8_t> &data, 
+        std::chrono::steady_clock::time_point arrivalTime){
+    bool extended = extendedControllerPackets;
+    uint32_t sequence = 0;
+    uint64_t sendTime = 0;
+    if(extended){
+        if(data.size() < CONTROLLER_EXT_HEADER_SIZE || data[0] != CONTROLLER_EXT_VERSION)
+            return;
+        sequence = Endian::readBig<uint32_t>(&data[1]);
+        sendTime = Endian::readBig<uint64_t>(&data[5]);
+        data.erase(data.begin(), data.begin() + CONTROLLER_EXT_HEADER_SIZE);
+    }
+
     // Only handle data that is long enough
     int l = data.size();
     if(l >= 4){
@@ -354,10 +801,25 @@ void NetworkManager::handleControllerData(std::vector<uint8_t> &data){
         if(l == calcLen){
             // Correct amount of data in this packet. handle the data
             int controllerNum = data[0];
-            if(controllerData.find(controllerNum) != controllerData.end()){
-                controllerData[controllerNum]->updateData(data);
+            std::shared_ptr<ControllerData> controller;
+            auto it = controllerData.find(controllerNum);
+            if(it != controllerData.end()){
+                if(extended && !it->second->acceptPacket(sequence, sendTime))
+                    return;
+                controller = it->second;
+                controller->updateData(data);
             }else{
-                controllerData[controllerNum] = std::make_shared<ControllerData>(data);
+                controller = std::make_shared<ControllerData>(data);
+                if(extended)
+                    controller->acceptPacket(sequence, sendTime);
+                controllerData[controllerNum] = controller;
+            }
+            FlightRecorder::recordController(controllerNum, data.data(), data.size());
+
+            if(LatencyTracer::isEnabled()){
+                std::lock_guard<std::mutex> l(controller->lock);
+                controller->traceFrame = LatencyTracer::nextFrame();
+                controller->arrivalTime = arrivalTime;
             }
         }
     }
@@ -20,21 +20,26 @@
 #include <arpirobot/core/network/NetworkTable.hpp>
 #include <arpirobot/core/network/NetworkManager.hpp>
 #include <arpirobot/core/log/Logger.hpp>
+#include <arpirobot/core/diag/FlightRecorder.hpp>
 #include <arpirobot/core/robot/BaseRobot.hpp>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <random>
 
 
 using namespace arpirobot;
 using namespace std::placeholders;
 
 
-std::unordered_map<std::string, std::string> NetworkTable::data;
+std::shared_ptr<NetworkTable::EntryMap> NetworkTable::data = std::make_shared<NetworkTable::EntryMap>();
 std::unordered_map<std::string, bool> NetworkTable::dataChanged;
 std::mutex NetworkTable::lock;
-bool NetworkTable::inSync = false;
+std::atomic<bool> NetworkTable::inSync {false};
+uint64_t NetworkTable::currentVersion = 0;
+uint64_t NetworkTable::syncVersion = 0;
+const uint32_t NetworkTable::epoch = std::random_device()() | 1; // Never 0 (0 means "no previous sync")
 
 void NetworkTable::set(std::string key, std::string value){
     setFromRobot(key, value);
@@ -42,24 +47,25 @@ void NetworkTable::set(std::string key, std::string value){
 
 std::string NetworkTable::get(std::string key){
     std::lock_guard<std::mutex> l(lock);
-    auto it = data.find(key);
-    if(it != data.end()){
+    auto it = data->find(key);
+    if(it != data->end()){
         dataChanged[key] = false;
-        return data[key];
+        return it->second.value;
     }
     return "";
 }
 
 bool NetworkTable::has(std::string key){
     std::lock_guard<std::mutex> l(lock);
-    auto it = data.find(key);
-    return it != data.end();
+    auto it = data->find(key);
+    return it != data->end();
 }
 
 bool NetworkTable::changed(std::string key){
+    std::lock_guard<std::mutex> l(lock);
     auto it = dataChanged.find(key);
     if(it != dataChanged.end()){
-        return dataChanged[key];
+        return it->second;
     }
     return false;
 }
@@ -69,50 +75,90 @@ bool NetworkTable::isInSync(){
     return inSync;
 }
 
-void NetworkTable::startSync(){
-    lock.lock();
-    inSync = true;
-    Logger::logDebug("Starting sync from robot to DS.");
+void NetworkTable::startSync(uint32_t sinceEpoch, uint64_t sinceVersion, bool versioned){
+    // Take a snapshot of the table. The lock is only held long enough to take a reference
+    // to the current map. Any changes made while the sync is running will copy the map 
+    // (see mutableData) instead of modifying the snapshot being sent.
+    std::shared_ptr<const EntryMap> snapshot;
+    uint64_t snapshotVersion;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        inSync = true;
+        snapshot = data;
+        syncVersion = currentVersion;
+        snapshotVersion = currentVersion;
+    }
+
+    // Only send changes if the DS has previously synced with this table and is not "ahead" of it
+    bool incremental = sinceEpoch == epoch && sinceVersion <= snapshotVersion;
+    if(incremental){
+        ARPIROBOT_LOG_DEBUG("Starting incremental sync from robot to DS (since version " + 
+            std::to_string(sinceVersion) + ").");
+    }else{
+        ARPIROBOT_LOG_DEBUG("Starting sync from robot to DS.");
+    }
 
-    if(!NetworkManager::sendNtRaw(asio::buffer(NET_TABLE_START_SYNC_DATA, 3))){
-        // abortSync will be called by handleDisconnect and lock will be released
+    if(!NetworkManager::sendNtRaw(asio::buffer(NET_TABLE_START_SYNC_DATA, 3), false)){
+        // Nothing was sent, so there is nothing for the DS to finish
+        inSync = false;
         return;
     }
 
-    sendAllValues();
+    sendValues(*snapshot, incremental, sinceVersion);
     if(!inSync){
         return;
     }
 
-    Logger::logDebug("Ending sync from robot to DS. Waiting for DS to sync data to robot.");
-    NetworkManager::sendNtRaw(asio::buffer(NET_TABLE_END_SYNC_DATA, 4));
+    ARPIROBOT_LOG_DEBUG("Ending sync from robot to DS. Waiting for DS to sync data to robot.");
+    if(versioned){
+        // Let the DS know which version it now has so the next sync can be incremental
+        std::string endData = NET_TABLE_END_SYNC_DATA.substr(0, 3) + std::to_string(epoch) + ":" + 
+            std::to_string(snapshotVersion) + "\n";
+        NetworkManager::sendNtRaw(asio::buffer(endData), false);
+    }else{
+        NetworkManager::sendNtRaw(asio::buffer(NET_TABLE_END_SYNC_DATA, 4), false);
+    }
 }
 
-void NetworkTable::sendAllValues(){
-    for(const auto &it : data){
+void NetworkTable::sendValues(const EntryMap &snapshot, bool incremental, uint64_t sinceVersion){
+    for(const auto &it : snapshot){
         if(!inSync){
             return;
         }
-        NetworkManager::sendNt(it.first, it.second);
+        if(!incremental || it.second.version > sinceVersion)
+            NetworkManager::sendNtSync(it.first, it.second.value);
     }
 }
 
 void NetworkTable::finishSync(std::unordered_map<std::string, std::string> dataFromDs){
-    Logger::logDebug("Got all sync data from DS to robot.");
+    ARPIROBOT_LOG_DEBUG("Got all sync data from DS to robot.");
+
+    std::lock_guard<std::mutex> l(lock);
+
+    // Values set by the robot while the snapshot was being sent were not sent to the DS
+    // (they could have been overwritten by older values in the snapshot). Send them now.
+    for(const auto &it : *data){
+        if(it.second.version > syncVersion){
+            NetworkManager::sendNt(it.first, it.second.value, false);
+        }
+    }
 
+    EntryMap &entries = mutableData();
     for(const auto &it : dataFromDs){
-        data[it.first] = it.second;
+        Entry &entry = entries[it.first];
+        entry.value = it.second;
+        entry.version = ++currentVersion;
         dataChanged[it.first] = true;
+        FlightRecorder::recordNetTable(it.first, it.second, true);
+        NetworkManager::sendNtToSubscribers(it.first, it.second);
     }
 
     inSync = false;
-    lock.unlock();
     Logger::logInfo("Network table sync complete.");
 }
 
 void NetworkTable::abortSync(){
     inSync = false;
-    lock.unlock();
     Logger::logWarning("Network table sync aborted.");
 }
 
@@ -120,15 +166,43 @@ void NetworkTable::setFromRobot(std::string key, std::string value){
     // Do not allow \n or 255 in the key or value
     std::replace(key.begin(), key.end(), (char)255, '\0');
     std::replace(key.begin(), key.end(), '\n', '\0');
-    {
-        std::lock_guard<std::mutex> l(lock);
-        data[key] = value;
-    }
-    NetworkManager::sendNt(key, value);
+    std::lock_guard<std::mutex> l(lock);
+    Entry &entry = mutableData()[key];
+    entry.value = value;
+    entry.version = ++currentVersion;
+    FlightRecorder::recordNetTable(key, value, false);
+
+    // Changes made during a sync are sent when the sync finishes.
+    // Otherwise queue the change (queued while locked so changes to a key are sent in order)
+    if(!inSync)
+        NetworkManager::sendNt(key, value);
 }
 
 void NetworkTable::setFromDs(std::string key, std::string value){
     std::lock_guard<std::mutex> l(lock);
-    data[key] = value;
+    Entry &entry = mutableData()[key];
+    entry.value = value;
+    entry.version = ++currentVersion;
     dataChanged[key] = true;
+    FlightRecorder::recordNetTable(key, value, true);
+    NetworkManager::sendNtToSubscribers(key, value);
+}
+
+void NetworkTable::setFromDs(const char *key, size_t keyLen, const char *value, size_t valueLen){
+    std::string keyStr(key, keyLen);
+    std::lock_guard<std::mutex> l(lock);
+    Entry &entry = mutableData()[keyStr];
+    entry.value.assign(value, valueLen); // Reuses existing value's storage when possible
+    entry.version = ++currentVersion;
+    dataChanged[keyStr] = true;
+    FlightRecorder::recordNetTable(keyStr, entry.value, true);
+    NetworkManager::sendNtToSubscribers(keyStr, entry.value);
+}
+
+NetworkTable::EntryMap &NetworkTable::mutableData(){
+    if(data.use_count() > 1){
+        // A sync is still sending the current map. Copy on write.
+        data = std::make_shared<EntryMap>(*data);
+    }
+    return *data;
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/network/RingBuffer.hpp>
+#include <algorithm>
+#include <cstring>
+
+using namespace arpirobot;
+
+
+RingBuffer::RingBuffer(size_t initialCapacity, size_t maxCapacity) : maxCapacity(maxCapacity){
+    size_t cap = 1;
+    while(cap < initialCapacity)
+        cap <<= 1;
+    buffer.resize(cap);
+}
+
+asio::mutable_buffer RingBuffer::prepare(size_t minSize){
+    if(buffer.size() - count < minSize)
+        grow(count + minSize);
+
+    // Free space starts after the readable data. It is contiguous until the end of the buffer
+    // or until the start of the readable data (if the readable data does not wrap)
+    size_t cap = buffer.size();
+    size_t tail = (head + count) & (cap - 1);
+    size_t contiguous;
+    if(count == cap){
+        contiguous = 0;
+    }else if(tail >= head){
+        contiguous = cap - tail;
+    }else{
+        contiguous = head - tail;
+    }
+    return asio::mutable_buffer(&buffer[tail], contiguous);
+}
+
+void RingBuffer::commit(size_t count){
+    this->count += count;
+}
+
+size_t RingBuffer::find(uint8_t b, size_t start) const{
+    if(start >= count)
+        return npos;
+    size_t cap = buffer.size();
+    size_t first = std::min(count, cap - head); // Readable bytes before wrapping
+    const uint8_t *data = buffer.data();
+
+    if(start < first){
+        const void *res = memchr(data + head + start, b, first - start);
+        if(res != nullptr)
+            return (const uint8_t*)res - (data + head);
+        start = first;
+    }
+    if(start < count){
+        // Search wrapped portion (starts at index 0 of buffer)
+        const void *res = memchr(data + (start - first), b, count - start);
+        if(res != nullptr)
+            return first + ((const uint8_t*)res - data);
+    }
+    return npos;
+}
+
+const uint8_t *RingBuffer::peek(size_t count){
+    size_t cap = buffer.size();
+    if(head + count <= cap)
+        return &buffer[head];
+
+    // Data wraps. Copy to contiguous scratch buffer.
+    if(scratch.size() < count)
+        scratch.resize(count);
+    size_t first = cap - head;
+    memcpy(scratch.data(), &buffer[head], first);
+    memcpy(scratch.data() + first, &buffer[0], count - first);
+    return scratch.data();
+}
+
+void RingBuffer::consume(size_t count){
+    count = std::min(count, this->count);
+    this->count -= count;
+    head = (this->count == 0) ? 0 : ((head + count) & (buffer.size() - 1));
+}
+
+void RingBuffer::clear(){
+    head = 0;
+    count = 0;
+}
+
+size_t RingBuffer::size() const{
+    return count;
+}
+
+size_t RingBuffer::capacity() const{
+    return buffer.size();
+}
+
+bool RingBuffer::full() const{
+    return count == buffer.size() && buffer.size() >= maxCapacity;
+}
+
+void RingBuffer::grow(size_t minCapacity){
+    size_t cap = buffer.size();
+    while(cap < minCapacity && cap < maxCapacity)
+        cap <<= 1;
+    if(cap == buffer.size())
+        return;
+
+    // Move readable data to the start of the new buffer
+    std::vector<uint8_t> newBuffer(cap);
+    size_t first = std::min(count, buffer.size() - head);
+    memcpy(newBuffer.data(), &buffer[head], first);
+    memcpy(newBuffer.data() + first, &buffer[0], count - first);
+    buffer.swap(newBuffer);
+    head = 0;
+}
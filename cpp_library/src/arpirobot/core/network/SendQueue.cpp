@@ -0,0 +1,230 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/network/SendQueue.hpp>
+
+using namespace arpirobot;
+using namespace std::placeholders;
+
+
+SendQueue::SendQueue(asio::io_service &io, size_t maxBytes, OverflowPolicy policy) : 
+        io(io), maxBytes(maxBytes), policy(policy){
+    gatherBuffers.reserve(MAX_GATHER);
+}
+
+void SendQueue::start(asio::ip::tcp::socket *socket, std::function<void(const std::error_code&)> errorHandler){
+    std::lock_guard<std::mutex> l(lock);
+    this->socket = socket;
+    this->errorHandler = errorHandler;
+    running = true;
+    if(writing){
+        // The write in progress is to the previous socket. Continue once it completes.
+        restarted = true;
+    }else if(items.size() > inFlight){
+        writing = true;
+        io.post(std::bind(&SendQueue::startWrite, this));
+    }
+}
+
+void SendQueue::stop(){
+    std::lock_guard<std::mutex> l(lock);
+    running = false;
+    errorHandler = nullptr;
+
+    // Frames currently being written must stay valid until the write handler runs
+    for(size_t i = inFlight; i < items.size(); ++i){
+        if(items[i].frame != nullptr){
+            stats.queuedBytes -= itemSize(items[i]);
+            stats.queuedFrames--;
+        }
+    }
+    items.erase(items.begin() + inFlight, items.end());
+    keySeqs.clear();
+}
+
+bool SendQueue::enqueue(std::shared_ptr<const std::string> frame, const std::string &key, bool droppable, 
+        asio::const_buffer prefix){
+    std::lock_guard<std::mutex> l(lock);
+    if(!running)
+        return false;
+
+    size_t size = frame->size() + prefix.size();
+
+    // Replace a queued frame with the same key
+    if(!key.empty()){
+        auto it = keySeqs.find(key);
+        if(it != keySeqs.end() && !items.empty()){
+            size_t pos = it->second - items.front().seq;
+            if(pos >= inFlight && pos < items.size() && items[pos].frame != nullptr){
+                Item &item = items[pos];
+                stats.queuedBytes = stats.queuedBytes - itemSize(item) + size;
+                item.frame = frame;
+                item.prefix = prefix;
+                item.droppable = item.droppable && droppable;
+                stats.coalescedFrames++;
+                return true;
+            }
+        }
+    }
+
+    // Make room (or give up) if over budget
+    if(droppable && stats.queuedBytes + size > maxBytes){
+        if(policy == OverflowPolicy::DROP_OLDEST){
+            for(size_t i = inFlight; i < items.size() && stats.queuedBytes + size > maxBytes; ++i){
+                if(items[i].frame != nullptr && items[i].droppable)
+                    dropItem(items[i]);
+            }
+        }
+        if(stats.queuedBytes + size > maxBytes){
+            stats.droppedBytes += size;
+            stats.droppedFrames++;
+            return false;
+        }
+    }
+
+    Item item;
+    item.frame = frame;
+    item.prefix = prefix;
+    item.key = key;
+    item.droppable = droppable;
+    item.seq = nextSeq++;
+    items.push_back(item);
+    if(!key.empty())
+        keySeqs[key] = item.seq;
+    stats.queuedBytes += size;
+    stats.queuedFrames++;
+
+    if(!writing){
+        writing = true;
+        io.post(std::bind(&SendQueue::startWrite, this));
+    }
+    return true;
+}
+
+void SendQueue::setMaxBytes(size_t maxBytes){
+    std::lock_guard<std::mutex> l(lock);
+    this->maxBytes = maxBytes;
+}
+
+bool SendQueue::idle(){
+    std::lock_guard<std::mutex> l(lock);
+    return !writing;
+}
+
+SendQueueStats SendQueue::getStats(){
+    std::lock_guard<std::mutex> l(lock);
+    return stats;
+}
+
+size_t SendQueue::itemSize(const Item &item){
+    return item.frame->size() + item.prefix.size();
+}
+
+void SendQueue::dropItem(Item &item){
+    stats.queuedBytes -= itemSize(item);
+    stats.queuedFrames--;
+    stats.droppedBytes += itemSize(item);
+    stats.droppedFrames++;
+    if(!item.key.empty()){
+        auto it = keySeqs.find(item.key);
+        if(it != keySeqs.end() && it->second == item.seq)
+            keySeqs.erase(it);
+    }
+    item.frame = nullptr;
+}
+
+void SendQueue::popFront(){
+    Item &item = items.front();
+    if(item.frame != nullptr){
+        stats.queuedBytes -= itemSize(item);
+        stats.queuedFrames--;
+        if(!item.key.empty()){
+            auto it = keySeqs.find(item.key);
+            if(it != keySeqs.end() && it->second == item.seq)
+                keySeqs.erase(it);
+        }
+    }
+    items.pop_front();
+}
+
+void SendQueue::startWrite(){
+    std::lock_guard<std::mutex> l(lock);
+
+    // Remove dropped frames from the front of the queue
+    while(!items.empty() && items.front().frame == nullptr)
+        popFront();
+
+    if(!running || socket == nullptr || !socket->is_open() || items.empty()){
+        writing = false;
+        return;
+    }
+
+    // Gather as many frames as possible into one write. Dropped frames in the middle
+    // are included in the in flight count, but not written.
+    gatherBuffers.clear();
+    inFlight = 0;
+    while(inFlight < items.size() && gatherBuffers.size() + 2 <= MAX_GATHER){
+        const Item &item = items[inFlight];
+        if(item.frame != nullptr){
+            if(item.prefix.size() > 0)
+                gatherBuffers.push_back(item.prefix);
+            gatherBuffers.push_back(asio::buffer(*item.frame));
+        }
+        inFlight++;
+    }
+
+    // In flight frames can no longer be replaced, so they no longer need to be found by key
+    for(size_t i = 0; i < inFlight; ++i){
+        const Item &item = items[i];
+        if(!item.key.empty()){
+            auto it = keySeqs.find(item.key);
+            if(it != keySeqs.end() && it->second == item.seq)
+                keySeqs.erase(it);
+        }
+    }
+
+    asio::async_write(*socket, gatherBuffers, std::bind(&SendQueue::handleWrite, this, _1, _2));
+}
+
+void SendQueue::handleWrite(const std::error_code &ec, std::size_t count){
+    std::function<void(const std::error_code&)> handler;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        stats.sentBytes += count;
+        for(size_t i = 0; i < inFlight && !items.empty(); ++i)
+            popFront();
+        inFlight = 0;
+        writing = false;
+
+        // Errors from a write started before the queue was restarted are not for the current socket
+        bool stale = restarted;
+        restarted = false;
+
+        if(ec && !stale){
+            handler = errorHandler;
+        }else if(running && !items.empty()){
+            writing = true;
+            io.post(std::bind(&SendQueue::startWrite, this));
+        }
+    }
+
+    // Called without lock held (handler will likely stop this queue)
+    if(ec && ec != asio::error::operation_aborted && handler != nullptr)
+        handler(ec);
+}
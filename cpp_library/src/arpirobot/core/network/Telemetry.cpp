@@ -0,0 +1,223 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/network/Telemetry.hpp>
+#include <arpirobot/core/network/NetworkManager.hpp>
+#include <arpirobot/core/network/NetworkTable.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+#include <arpirobot/core/log/Logger.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace arpirobot;
+
+
+std::vector<Telemetry::Source> Telemetry::sources;
+std::mutex Telemetry::sourcesLock;
+std::thread *Telemetry::thread = nullptr;
+std::atomic<bool> Telemetry::running {false};
+std::atomic<uint64_t> Telemetry::sentRecords {0};
+std::atomic<uint64_t> Telemetry::failedSends {0};
+std::vector<uint8_t> Telemetry::datagram;
+std::vector<float> Telemetry::sampleBuf;
+
+
+int Telemetry::addSource(std::string name, std::vector<std::string> fields, std::function<void(float*)> sampleFunc){
+    if(fields.size() == 0 || fields.size() > MAX_FIELDS){
+        Logger::logWarningFrom("Telemetry", "Source " + name + " must have between 1 and " + 
+            std::to_string(MAX_FIELDS) + " fields.");
+        return -1;
+    }
+    int id;
+    {
+        std::lock_guard<std::mutex> l(sourcesLock);
+        if(sources.size() >= 255){
+            Logger::logWarningFrom("Telemetry", "Too many telemetry sources. Source " + name + " not added.");
+            return -1;
+        }
+        id = sources.size();
+        Source src;
+        src.name = name;
+        src.fields = fields;
+        src.sampleFunc = sampleFunc;
+        src.seq = 0;
+        sources.push_back(src);
+    }
+    announceSchema();
+    return id;
+}
+
+void Telemetry::removeSource(int id){
+    {
+        // Held while sampling, so the source is not being sampled once this returns
+        std::lock_guard<std::mutex> l(sourcesLock);
+        if(id < 0 || (size_t)id >= sources.size() || sources[id].sampleFunc == nullptr)
+            return;
+        sources[id].sampleFunc = nullptr;
+    }
+    announceSchema();
+}
+
+uint64_t Telemetry::getSentRecords(){
+    return sentRecords;
+}
+
+uint64_t Telemetry::getFailedSends(){
+    return failedSends;
+}
+
+void Telemetry::start(){
+    if(running)
+        return;
+    running = true;
+    announceSchema();
+    thread = new std::thread(&Telemetry::run);
+}
+
+void Telemetry::stop(){
+    running = false;
+    if(thread != nullptr){
+        thread->join();
+        delete thread;
+        thread = nullptr;
+    }
+}
+
+void Telemetry::run(){
+    auto nextRun = std::chrono::steady_clock::now();
+    while(running){
+        auto period = std::chrono::milliseconds(std::max(RobotProfile::telemetryPeriod, 1));
+        nextRun += period;
+
+        bool hasSources;
+        {
+            std::lock_guard<std::mutex> l(sourcesLock);
+            hasSources = sources.size() > 0;
+        }
+        if(hasSources && NetworkManager::hasTelemetryClients())
+            sampleAndSend();
+
+        auto now = std::chrono::steady_clock::now();
+        if(nextRun < now){
+            // Fell behind. Don't try to catch up.
+            nextRun = now;
+        }else{
+            std::this_thread::sleep_until(nextRun);
+        }
+    }
+}
+
+void Telemetry::sampleAndSend(){
+    std::lock_guard<std::mutex> l(sourcesLock);
+
+    // One datagram contains records from as many sources as fit
+    datagram.clear();
+    size_t recordCountPos = 0;
+    uint8_t recordCount = 0;
+    for(size_t id = 0; id < sources.size(); ++id){
+        Source &src = sources[id];
+        if(src.sampleFunc == nullptr)
+            continue;
+        size_t recordSize = 1 + 4 + 8 + 4 * src.fields.size();
+
+        if(datagram.size() > 0 && datagram.size() + recordSize > MAX_DATAGRAM_SIZE){
+            if(NetworkManager::sendTelemetry(datagram))
+                sentRecords += recordCount;
+            else
+                failedSends++;
+            datagram.clear();
+        }
+        if(datagram.size() == 0){
+            // Header: 'T', 'L', version, record count
+            datagram.push_back('T');
+            datagram.push_back('L');
+            datagram.push_back(1);
+            recordCountPos = datagram.size();
+            datagram.push_back(0);
+            recordCount = 0;
+        }
+
+        sampleBuf.resize(src.fields.size());
+        try{
+            src.sampleFunc(sampleBuf.data());
+        }catch(const std::exception &e){
+            std::fill(sampleBuf.begin(), sampleBuf.end(), NAN);
+        }
+        uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        // Record: source id, sequence number, timestamp (us), fields (little endian)
+        datagram.push_back(id);
+        appendU32(datagram, src.seq++);
+        appendU64(datagram, timestamp);
+        for(float f : sampleBuf){
+            uint32_t bits;
+            memcpy(&bits, &f, 4);
+            appendU32(datagram, bits);
+        }
+        datagram[recordCountPos] = ++recordCount;
+    }
+    if(datagram.size() > 0){
+        if(NetworkManager::sendTelemetry(datagram))
+            sentRecords += recordCount;
+        else
+            failedSends++;
+    }
+}
+
+void Telemetry::announceSchema(){
+    // Schema format: id:name:field,field,...;id:name:field,...
+    std::string schema;
+    {
+        std::lock_guard<std::mutex> l(sourcesLock);
+        for(size_t id = 0; id < sources.size(); ++id){
+            if(sources[id].sampleFunc == nullptr)
+                continue;
+            if(!schema.empty())
+                schema += ";";
+            schema += std::to_string(id) + ":" + sanitize(sources[id].name) + ":";
+            for(size_t i = 0; i < sources[id].fields.size(); ++i){
+                if(i != 0)
+                    schema += ",";
+                schema += sanitize(sources[id].fields[i]);
+            }
+        }
+    }
+    NetworkTable::set("telemetry_schema", schema);
+}
+
+std::string Telemetry::sanitize(std::string str){
+    std::replace(str.begin(), str.end(), ':', '_');
+    std::replace(str.begin(), str.end(), ';', '_');
+    std::replace(str.begin(), str.end(), ',', '_');
+    return str;
+}
+
+void Telemetry::appendU32(std::vector<uint8_t> &buf, uint32_t val){
+    buf.push_back(val);
+    buf.push_back(val >> 8);
+    buf.push_back(val >> 16);
+    buf.push_back(val >> 24);
+}
+
+void Telemetry::appendU64(std::vector<uint8_t> &buf, uint64_t val){
+    appendU32(buf, val);
+    appendU32(buf, val >> 32);
+}
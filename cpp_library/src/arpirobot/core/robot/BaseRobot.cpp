@@ -21,16 +21,20 @@
 #include <arpirobot/core/robot/RobotProfile.hpp>
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/network/NetworkManager.hpp>
+#include <arpirobot/core/network/Telemetry.hpp>
 #include <arpirobot/core/action/ActionManager.hpp>
 #include <arpirobot/core/conversions.hpp>
 #include <arpirobot/core/io/Io.hpp>
 #include <arpirobot/core/audio/AudioManager.hpp>
+#include <arpirobot/core/diag/LatencyTracer.hpp>
+#include <arpirobot/core/diag/FlightRecorder.hpp>
 
 
 #include <stdexcept>
 #include <chrono>
 #include <csignal>
 #include <cstdlib>
+#include <algorithm>
 
 
 using namespace arpirobot;
@@ -85,7 +89,7 @@ void BaseRobot::start(){
         Io::init(RobotProfile::ioProvider);
     }catch(std::runtime_error &e){
         Logger::logError("Failed to initialize IO library.");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
         exit(1);
     }
 
@@ -103,11 +107,16 @@ void BaseRobot::start(){
     signal(SIGCONT, &BaseRobot::ignoreSignalHandler);
 #endif
 
-    NetworkManager::startNetworking(std::bind(&BaseRobot::onEnable, this), 
-            std::bind(&BaseRobot::onDisable, this));
+    FlightRecorder::start();
+
+    // Enable and disable run on the scheduler, not the network thread
+    NetworkManager::startNetworking(std::bind(&BaseRobot::requestStateChange, this, true), 
+            std::bind(&BaseRobot::requestStateChange, this, false));
 
     NetworkTable::set("robotstate", "DISABLED");
 
+    Telemetry::start();
+
     // Begin any devices that were instantiated before the robot was started
     {
         // Lock to prevent allowing new devices being added to this list now
@@ -119,7 +128,7 @@ void BaseRobot::start(){
                 device->doBegin();
             }catch(const std::exception &e){
                 Logger::logError("Failed to begin device " + device->getDeviceName());
-                Logger::logDebug(e.what());
+                ARPIROBOT_LOG_DEBUG(e.what());
                 exit(1);
             }
         }
@@ -173,7 +182,9 @@ void BaseRobot::start(){
         device->disable();
     }
 
+    Telemetry::stop();
     NetworkManager::stopNetworking();
+    FlightRecorder::stop();
 
     // No need to call this here. This will be called at exit (atexit handler)
     // Io::terminate();
@@ -181,6 +192,10 @@ void BaseRobot::start(){
     AudioManager::finish();
 }
 
+const LatencyHistogram &BaseRobot::getStateChangeLatency(){
+    return stateChangeLatency;
+}
+
 std::shared_ptr<Task> BaseRobot::scheduleRepeatedFunction(const std::function<void()> &&func, sched_clk::duration rate){
     if(scheduler == nullptr)
         return nullptr;
@@ -225,6 +240,11 @@ void BaseRobot::ignoreSignalHandler(int signal){
 }
 
 void BaseRobot::modeBasedPeriodic(){
+    // In case a request was queued while another thread was processing requests
+    processStateChanges();
+
+    LatencyTracer::clearContext();
+
     try{
         if(isEnabled){
             enabledPeriodic();
@@ -233,16 +253,17 @@ void BaseRobot::modeBasedPeriodic(){
         }
     }catch(const std::runtime_error &e){
         Logger::logError("Error running mode based periodic function!");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
     }
 }
 
 void BaseRobot::doPeriodic(){
+    LatencyTracer::clearContext();
     try{
         periodic();
     }catch(const std::runtime_error &e){
         Logger::logError("Error running periodic!");
-        Logger::logDebug(e.what());
+        ARPIROBOT_LOG_DEBUG(e.what());
     }
 }
 
@@ -280,11 +301,12 @@ void BaseRobot::onDisable(){
         }
 
         Logger::logInfo("Robot disabled.");
+        FlightRecorder::recordState(false);
         try{
             robotDisabled();
         }catch(const std::runtime_error &e){
             Logger::logError("Error running robotDisabled!");
-            Logger::logDebug(e.what());
+            ARPIROBOT_LOG_DEBUG(e.what());
         }
         isEnabled = false;
     }
@@ -300,12 +322,60 @@ void BaseRobot::onEnable(){
         }
 
         Logger::logInfo("Robot enabled.");
+        FlightRecorder::recordState(true);
         try{
             robotEnabled();
         }catch(const std::runtime_error &e){
             Logger::logError("Error running robotEnabled!");
-            Logger::logDebug(e.what());
+            ARPIROBOT_LOG_DEBUG(e.what());
         }
         isEnabled = true;
     }
 }
+
+void BaseRobot::requestStateChange(bool enable){
+    uint64_t arrivalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Replace any request not yet applied. The new request must compare newer than the current one.
+    uint64_t current = stateRequest.load();
+    uint64_t request;
+    do{
+        request = (std::max(arrivalNs, (current >> 1) + 1) << 1) | (enable ? 1 : 0);
+    }while(!stateRequest.compare_exchange_weak(current, request));
+
+    // Only schedule processing if it is not already scheduled
+    if(!stateChangeScheduled.exchange(true)){
+        runOnceSoon([this](){
+            stateChangeScheduled = false;
+            processStateChanges();
+        });
+    }
+}
+
+void BaseRobot::processStateChanges(){
+    // A request can be made just after this thread finishes processing, while another thread 
+    // that was scheduled to process it gave up. Check again after releasing.
+    do{
+        if(processingStateChanges.exchange(true, std::memory_order_acquire)){
+            // Another thread is processing requests
+            return;
+        }
+
+        uint64_t request = stateRequest.load();
+        if(request != appliedStateRequest){
+            appliedStateRequest = request;
+            if(request & 1){
+                onEnable();
+            }else{
+                onDisable();
+            }
+            uint64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            uint64_t arrivalNs = request >> 1;
+            stateChangeLatency.record(nowNs > arrivalNs ? nowNs - arrivalNs : 0);
+        }
+
+        processingStateChanges.store(false, std::memory_order_release);
+    }while(stateRequest != appliedStateRequest);
+}
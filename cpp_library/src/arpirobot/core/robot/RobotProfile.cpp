@@ -29,3 +29,22 @@ int RobotProfile::maxGamepadDataAge = 100;
 int RobotProfile::actionFunctionPeriod = 50;
 int RobotProfile::deviceWatchdogDur = 500;
 std::string RobotProfile::ioProvider = "";
+std::string RobotProfile::networkBindAddress = "0.0.0.0";
+int RobotProfile::controllerPort = 8090;
+int RobotProfile::commandPort = 8091;
+int RobotProfile::netTablePort = 8092;
+int RobotProfile::logPort = 8093;
+int RobotProfile::netTableSendBufferSize = 256 * 1024;
+int RobotProfile::logSendBufferSize = 64 * 1024;
+int RobotProfile::logQueueSize = 1024;
+int RobotProfile::telemetryPort = 8094;
+int RobotProfile::telemetryPeriod = 10;
+int RobotProfile::subscriberPort = 8095;
+int RobotProfile::maxSubscribers = 4;
+int RobotProfile::subscriberSendBufferSize = 128 * 1024;
+int RobotProfile::clockSyncPeriod = 1000;
+bool RobotProfile::handlerStats = false;
+bool RobotProfile::latencyTracing = false;
+int RobotProfile::latencyTraceRecords = 4096;
+std::string RobotProfile::flightRecorderFile = "";
+int RobotProfile::flightRecorderSize = 4 * 1024 * 1024;
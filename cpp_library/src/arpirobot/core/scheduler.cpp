@@ -171,10 +171,10 @@ void Scheduler::serviceTasks(){
                     task->targetFunction();
                 }catch(const std::exception &e){
                     Logger::logErrorFrom("Scheduler", "Error in scheduled task.");
-                    Logger::logDebugFrom("Scheduler", std::string(e.what()));
+                    ARPIROBOT_LOG_DEBUG_FROM("Scheduler", std::string(e.what()));
                 }catch(const std::string &e){
                     Logger::logErrorFrom("Scheduler", "Error in scheduled task.");
-                    Logger::logDebugFrom("Scheduler", e);
+                    ARPIROBOT_LOG_DEBUG_FROM("Scheduler", e);
                 }catch(...){
                     Logger::logErrorFrom("Scheduler", "Error in scheduled task.");
                 }
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+#include <arpirobot/core/util/Crc16.hpp>
+
+#if defined(__aarch64__) && defined(__linux__) && defined(__GNUC__)
+#define ARPIROBOT_CRC_PMULL 1
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#else
+#define ARPIROBOT_CRC_PMULL 0
+#endif
+
+using namespace arpirobot;
+
+
+namespace{
+
+    const uint16_t POLY = 0x1021;
+
+    /*
+     * Slice-by-8 lookup tables, generated at compile time.
+     * table[0][b] is the CRC (from 0) of byte b. table[k][b] is the CRC of byte b followed
+     * by k zero bytes, so eight bytes can be combined with eight independent lookups.
+     */
+    struct CrcTables{
+        uint16_t table[8][256];
+
+        constexpr CrcTables() : table{}{
+            for(int b = 0; b < 256; ++b){
+                uint16_t crc = b << 8;
+                for(int i = 0; i < 8; ++i)
+                    crc = (crc & 0x8000) ? (crc << 1) ^ POLY : crc << 1;
+                table[0][b] = crc;
+            }
+            for(int k = 1; k < 8; ++k){
+                for(int b = 0; b < 256; ++b){
+                    uint16_t prev = table[k - 1][b];
+                    table[k][b] = (prev << 8) ^ table[0][prev >> 8];
+                }
+            }
+        }
+    };
+
+    constexpr CrcTables TABLES;
+
+    // Known values of the generated table
+    static_assert(TABLES.table[0][1] == 0x1021, "Bad CRC table");
+    static_assert(TABLES.table[0][255] == 0x1EF0, "Bad CRC table");
+
+    inline uint16_t tableByte(uint16_t crc, uint8_t b){
+        return (crc << 8) ^ TABLES.table[0][(crc >> 8) ^ b];
+    }
+
+    inline uint64_t loadBigEndian64(const uint8_t *p){
+        return (uint64_t)p[0] << 56 | (uint64_t)p[1] << 48 | (uint64_t)p[2] << 40 | (uint64_t)p[3] << 32 |
+            (uint64_t)p[4] << 24 | (uint64_t)p[5] << 16 | (uint64_t)p[6] << 8 | (uint64_t)p[7];
+    }
+
+    /*
+     * Low 64 bits of floor(x^80 / P) for P = x^16 + POLY. The x^64 term (always set) is not stored.
+     * Used for Barrett reduction in foldCrc.
+     */
+    constexpr uint64_t barrettMu(){
+        uint64_t mu = 0;
+        uint32_t rem = 0x10000;
+        for(int bit = 64; bit >= 0; --bit){
+            if(rem & 0x10000){
+                if(bit < 64)
+                    mu |= (uint64_t)1 << bit;
+                rem ^= 0x10000 | POLY;
+            }
+            rem <<= 1;
+        }
+        return mu;
+    }
+
+    constexpr uint64_t BARRETT_MU = barrettMu();
+}
+
+
+uint16_t Crc16::ccittFalseBitwise(const uint8_t *data, size_t len, uint16_t crc){
+    for(size_t pos = 0; pos < len; ++pos){
+        uint8_t b = data[pos];
+        for(int i = 0; i < 8; ++i){
+            uint8_t bit = ((b >> (7 - i) & 1) == 1);
+            uint8_t c15 = ((crc >> 15 & 1) == 1);
+            crc <<= 1;
+            if(c15 ^ bit){
+                crc ^= POLY;
+            }
+        }
+    }
+    return crc;
+}
+
+uint16_t Crc16::ccittFalseTable(const uint8_t *data, size_t len, uint16_t crc){
+    const auto &t = TABLES.table;
+    while(len >= 8){
+        // The current CRC is combined with the first two bytes
+        uint8_t b0 = data[0] ^ (crc >> 8);
+        uint8_t b1 = data[1] ^ (crc & 0xFF);
+        crc = t[7][b0] ^ t[6][b1] ^ t[5][data[2]] ^ t[4][data[3]] ^
+            t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    while(len-- > 0)
+        crc = tableByte(crc, *data++);
+    return crc;
+}
+
+
+#if ARPIROBOT_CRC_PMULL
+// PMULL is an optional ARMv8 feature. Only the code below is compiled to use it, and it is only
+// called if the CPU supports it.
+#pragma GCC push_options
+#pragma GCC target("+crypto")
+#endif
+
+namespace{
+    /*
+     * CRC of eight bytes at a time using carry-less multiplication. Clmul::mul(a, b, lo, hi) gives
+     * the 128-bit carry-less product of a and b.
+     * For each 64-bit block M (first byte most significant) the new CRC is
+     *     ((M + crc * x^48) * x^16) mod P
+     * computed with Barrett reduction: q = floor(A * floor(x^80 / P) / x^64), crc = low 16 bits of q * P.
+     * Over GF(2) this is exact.
+     */
+    template <typename Clmul>
+    inline uint16_t foldCrc(const uint8_t *data, size_t len, uint16_t crc){
+        while(len >= 8){
+            uint64_t a = loadBigEndian64(data) ^ ((uint64_t)crc << 48);
+            uint64_t lo, hi;
+            Clmul::mul(a, BARRETT_MU, lo, hi);
+            uint64_t q = hi ^ a; // The x^64 term of mu contributes a itself
+            Clmul::mul(q, POLY, lo, hi);
+            crc = (uint16_t)lo;
+            data += 8;
+            len -= 8;
+        }
+        while(len-- > 0)
+            crc = tableByte(crc, *data++);
+        return crc;
+    }
+}
+
+#if ARPIROBOT_CRC_PMULL
+
+namespace{
+    struct PmullClmul{
+        static inline void mul(uint64_t a, uint64_t b, uint64_t &lo, uint64_t &hi){
+            uint64x2_t res = vreinterpretq_u64_p128(vmull_p64((poly64_t)a, (poly64_t)b));
+            lo = vgetq_lane_u64(res, 0);
+            hi = vgetq_lane_u64(res, 1);
+        }
+    };
+
+    uint16_t pmullCrc(const uint8_t *data, size_t len, uint16_t crc){
+        return foldCrc<PmullClmul>(data, len, crc);
+    }
+}
+
+#pragma GCC pop_options
+
+#endif // ARPIROBOT_CRC_PMULL
+
+
+namespace{
+    bool detectPmull(){
+#if ARPIROBOT_CRC_PMULL
+        return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#else
+        return false;
+#endif
+    }
+
+    const bool PMULL_SUPPORTED = detectPmull();
+}
+
+bool Crc16::hasPmull(){
+    return PMULL_SUPPORTED;
+}
+
+uint16_t Crc16::ccittFalsePmull(const uint8_t *data, size_t len, uint16_t crc){
+#if ARPIROBOT_CRC_PMULL
+    if(PMULL_SUPPORTED)
+        return pmullCrc(data, len, crc);
+#endif
+    return ccittFalseTable(data, len, crc);
+}
+
+uint16_t Crc16::ccittFalse(const uint8_t *data, size_t len, uint16_t crc){
+    return ccittFalsePmull(data, len, crc);
+}
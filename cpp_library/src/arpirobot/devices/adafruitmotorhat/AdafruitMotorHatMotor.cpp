@@ -248,7 +248,7 @@ void AdafruitMotorHatMotor::begin(){
             hat = std::make_shared<AdafruitMotorHat>(hatAddress, hatBus);
         }catch(const std::exception &e){
             Logger::logWarningFrom(getDeviceName(), "Failed to initialize motor hat.");
-            Logger::logDebugFrom(getDeviceName(), e.what());
+            ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
         }
         hatMap[hatId] = hat;
     }
@@ -311,7 +311,7 @@ void AdafruitMotorHatMotor::run(){
             motor->run(MotorCommand::RELEASE);
         }
     }catch(const std::exception &e){
-        Logger::logWarningFrom(getDeviceName(), "Failed to set motor speed.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_WARNING_FROM_LIMITED(getDeviceName(), "Failed to set motor speed.");
+        ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), e.what());
     }
 }
\ No newline at end of file
@@ -45,7 +45,7 @@ void DRV8833Motor::begin(){
         Io::gpioWrite(slp, Io::GPIO_HIGH);
     }catch(const std::exception &e){
         Logger::logErrorFrom(getDeviceName(), "Failed to initialize device. GPIO error.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
     }
 }
 
@@ -70,8 +70,8 @@ void DRV8833Motor::run(){
             }
         }
     }catch(const std::exception &e){
-        Logger::logWarningFrom(getDeviceName(), "Failed to set motor speed.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_WARNING_FROM_LIMITED(getDeviceName(), "Failed to set motor speed.");
+        ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), e.what());
     }
 }
 
@@ -21,6 +21,7 @@
 #include <arpirobot/core/network/NetworkManager.hpp>
 #include <arpirobot/core/robot/BaseRobot.hpp>
 #include <arpirobot/core/log/Logger.hpp>
+#include <arpirobot/core/diag/LatencyTracer.hpp>
 
 using namespace arpirobot;
 
@@ -54,6 +55,7 @@ double Gamepad::getAxis(int axisNum, double deadband){
             // Data too old
             return 0;
         }
+        LatencyTracer::noteInput(data->traceFrame, controllerNum, data->arrivalTime);
 
         // Get value and apply deadband
         double value = data->axes[axisNum];
@@ -96,6 +98,7 @@ bool Gamepad::getButton(int buttonNum){
             // Data too old
             return false;
         }
+        LatencyTracer::noteInput(data->traceFrame, controllerNum, data->arrivalTime);
 
         return data->buttons[buttonNum];
     }
@@ -122,11 +125,21 @@ int Gamepad::getDpad(int dpadNum){
             // Data too old
             return false;
         }
+        LatencyTracer::noteInput(data->traceFrame, controllerNum, data->arrivalTime);
 
         return data->dpads[dpadNum];
     }
 }
 
+ControllerLinkStats Gamepad::getLinkStats(){
+    auto it = NetworkManager::controllerData.find(controllerNum);
+    if(it == NetworkManager::controllerData.end()){
+        // No data for this controller
+        return ControllerLinkStats();
+    }
+    return it->second->getLinkStats();
+}
+
 void Gamepad::setAxisTransform(int axisNum, BaseAxisTransform &transform){
     setAxisTransform(axisNum, std::shared_ptr<BaseAxisTransform>(std::shared_ptr<BaseAxisTransform>{}, &transform));
 }
@@ -50,7 +50,7 @@ void StatusLED::begin(){
         Io::gpioMode(pin, Io::GPIO_OUT);
     }catch(const std::exception &e){
         Logger::logErrorFrom(getDeviceName(), "Failed to initialize device. GPIO error.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
     }
 }
 
@@ -22,6 +22,7 @@
 #include <arpirobot/core/log/Logger.hpp>
 #include <arpirobot/core/robot/BaseRobot.hpp>
 #include <arpirobot/core/io/Io.hpp>
+#include <arpirobot/core/network/Telemetry.hpp>
 
 #include <stdexcept>
 #include <thread>
@@ -232,6 +233,7 @@ INA260PowerSensor::INA260PowerSensor(int bus) : bus(bus){
 }
 
 INA260PowerSensor::~INA260PowerSensor(){
+    Telemetry::removeSource(telemetrySourceId);
     stop = true;
 }
 
@@ -247,6 +249,16 @@ double INA260PowerSensor::getPower(){
     return power;
 }
 
+int INA260PowerSensor::addTelemetrySource(){
+    Telemetry::removeSource(telemetrySourceId);
+    telemetrySourceId = Telemetry::addSource(getDeviceName(), {"current", "voltage", "power"}, [this](float *values){
+        values[0] = getCurrent();
+        values[1] = getVolgate();
+        values[2] = getPower();
+    });
+    return telemetrySourceId;
+}
+
 void INA260PowerSensor::begin(){
     try{
         if(bus == -1)
@@ -254,11 +266,11 @@ void INA260PowerSensor::begin(){
         sensor = std::make_shared<AdafruitINA260>(0x40, bus);
     }catch(const std::exception &e){
         Logger::logErrorFrom(getDeviceName(), "Failed to initialize sensor.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
     }
     if(!sensor->begin()){
         Logger::logErrorFrom(getDeviceName(), "Failed to initialize sensor.");
-        Logger::logDebugFrom(getDeviceName(), "Incorrect device at given adddress.");
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), "Incorrect device at given adddress.");
         return;
     }
     BaseRobot::runOnceSoon(std::bind(&INA260PowerSensor::feed, this));
@@ -294,8 +306,8 @@ void INA260PowerSensor::feed(){
             if(isMainVmon())
                 sendMainBatteryVoltage(voltage);
         }catch(const std::exception &e){
-            Logger::logWarningFrom(getDeviceName(), "Failed to read data.");
-            Logger::logDebugFrom(getDeviceName(), e.what());
+            ARPIROBOT_LOG_WARNING_FROM_LIMITED(getDeviceName(), "Failed to read data.");
+            ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), e.what());
         }
 
         // Instead of running this every 50ms (using scheduler repeated task)
@@ -47,7 +47,7 @@ void L298NMotor::begin(){
         Io::gpioPwm(pwm, 0);
     }catch(const std::exception &e){
         Logger::logErrorFrom(getDeviceName(), "Failed to initialize device. GPIO error.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_DEBUG_FROM(getDeviceName(), e.what());
     }
 }
 
@@ -72,8 +72,8 @@ void L298NMotor::run(){
             Io::gpioPwm(pwm, (int)(std::abs(speed) * 255));
         }
     }catch(const std::exception &e){
-        Logger::logWarningFrom(getDeviceName(), "Failed to set motor speed.");
-        Logger::logDebugFrom(getDeviceName(), e.what());
+        ARPIROBOT_LOG_WARNING_FROM_LIMITED(getDeviceName(), "Failed to set motor speed.");
+        ARPIROBOT_LOG_DEBUG_FROM_LIMITED(getDeviceName(), e.what());
     }
 }
 
@@ -0,0 +1,131 @@
+/*
+ * Checks and benchmarks the CRC-16/CCITT-FALSE implementations in Crc16 (used for arduino messages).
+ *
+ * First every implementation is checked against known answers and against the bitwise reference
+ * implementation on random data (random lengths, initial values and split points). The program
+ * exits with status 1 if any result differs. Then each implementation is timed for several
+ * message sizes.
+ *
+ * Usage: crc-bench [--check-only]
+ */
+
+#include <arpirobot/core/util/Crc16.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstring>
+
+using namespace arpirobot;
+typedef std::chrono::steady_clock Clock;
+typedef uint16_t (*CrcFunc)(const uint8_t *data, size_t len, uint16_t crc);
+
+
+struct Impl{
+    const char *name;
+    CrcFunc func;
+};
+
+static const Impl IMPLS[] = {
+    {"bitwise", &Crc16::ccittFalseBitwise},
+    {"table", &Crc16::ccittFalseTable},
+    {"pmull", &Crc16::ccittFalsePmull},
+    {"default", &Crc16::ccittFalse}
+};
+
+struct KnownAnswer{
+    const char *data;
+    uint16_t crc;
+};
+
+// Known answers for CRC-16/CCITT-FALSE
+static const KnownAnswer KNOWN[] = {
+    {"", 0xFFFF},
+    {"A", 0xB915},
+    {"123456789", 0x29B1},
+    {"The quick brown fox jumps over the lazy dog", 0x8FDD}
+};
+
+
+static bool check(){
+    int failures = 0;
+    for(const Impl &impl : IMPLS){
+        for(const KnownAnswer &ka : KNOWN){
+            uint16_t crc = impl.func(reinterpret_cast<const uint8_t*>(ka.data), std::strlen(ka.data), Crc16::CCITT_FALSE_INIT);
+            if(crc != ka.crc){
+                std::cerr << impl.name << ": CRC of \"" << ka.data << "\" is 0x" << std::hex << crc <<
+                    " (expected 0x" << ka.crc << ")" << std::dec << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(1024);
+    for(int i = 0; i < 20000 && failures < 10; ++i){
+        size_t len = rng() % (i < 10000 ? 64 : data.size());
+        for(size_t j = 0; j < len; ++j)
+            data[j] = rng();
+        uint16_t init = rng();
+        size_t split = len == 0 ? 0 : rng() % len;
+        uint16_t expected = Crc16::ccittFalseBitwise(data.data(), len, init);
+        for(const Impl &impl : IMPLS){
+            uint16_t crc = impl.func(data.data(), len, init);
+            // Computed in two pieces
+            uint16_t splitCrc = impl.func(data.data() + split, len - split, impl.func(data.data(), split, init));
+            if(crc != expected || splitCrc != expected){
+                std::cerr << impl.name << ": wrong CRC for " << len << " random bytes" << std::endl;
+                failures++;
+            }
+        }
+    }
+    return failures == 0;
+}
+
+static void bench(const Impl &impl, size_t size){
+    std::vector<uint8_t> data(size);
+    for(size_t i = 0; i < size; ++i)
+        data[i] = (uint8_t)(i * 131 + 7);
+
+    // Run for about 0.2 seconds
+    uint64_t iterations = 0;
+    uint16_t crc = 0;
+    auto start = Clock::now();
+    auto end = start + std::chrono::milliseconds(200);
+    auto now = start;
+    while(now < end){
+        for(int i = 0; i < 1000; ++i)
+            crc ^= impl.func(data.data(), size, Crc16::CCITT_FALSE_INIT + crc);
+        iterations += 1000;
+        now = Clock::now();
+    }
+    double ns = std::chrono::duration<double, std::nano>(now - start).count();
+
+    // Print crc so the loop can not be optimized away
+    std::cout << std::left << std::setw(10) << impl.name << std::right << std::setw(6) << size << " bytes"
+        << std::fixed << std::setprecision(1)
+        << std::setw(10) << ns / iterations << " ns/call"
+        << std::setw(10) << size * iterations / ns * 1e3 << " MB/s"
+        << "   (" << std::hex << crc << std::dec << ")" << std::endl;
+}
+
+int main(int argc, char **argv){
+    bool checkOnly = argc > 1 && std::string(argv[1]) == "--check-only";
+
+    std::cout << "PMULL " << (Crc16::hasPmull() ? "supported" : "not supported") << std::endl;
+    if(!check()){
+        std::cerr << "CRC check FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "All implementations match the reference" << std::endl;
+    if(checkOnly)
+        return 0;
+
+    for(size_t size : {8, 20, 64, 256, 4096}){
+        for(const Impl &impl : IMPLS)
+            bench(impl, size);
+    }
+    return 0;
+}
@@ -0,0 +1,435 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/*
+ * Headless drive station emulator for load testing the robot's networking.
+ * Connects to the robot like a drive station (see NetworkManager for the protocol), then
+ * sends controller packets and net table updates at fixed rates while periodically enabling,
+ * disabling and syncing the net table. Latency of enable / disable (until the robot logs
+ * "Robot enabled." / "Robot disabled.") and of net table syncs is measured.
+ *
+ * In bench mode NetworkManager is run in this process (no robot program needed) and the time
+ * spent in its receive handlers is reported.
+ *
+ * Usage: ds-emulator [options]
+ *     --host ADDR             Robot address (default 127.0.0.1, ignored with --bench)
+ *     --port-base PORT        Robot's controller port. Command, net table and log ports follow it
+ *                             (default 8090). With --bench the in process robot listens on these ports.
+ *     --duration SEC          How long to run (default 10)
+ *     --controllers N         Number of controllers to emulate (default 1)
+ *     --controller-rate HZ    Packets per second per controller (default 50)
+ *     --nt-rate HZ            Net table updates per second (default 0)
+ *     --nt-keys N             Number of distinct keys net table updates cycle through (default 100)
+ *     --enable-interval SEC   Toggle enable / disable this often (default 1, 0 to disable)
+ *     --sync-interval SEC     Start a net table sync this often (default 2, 0 for only one at start)
+ *     --ctrl-ext              Send extended controller packets (sequence number and send time)
+ *     --clock-sync            Answer the robot's clock sync pings
+ *     --bench                 Run NetworkManager in process and report handler statistics
+ */
+
+#include <arpirobot/core/network/NetworkManager.hpp>
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
+#include <arpirobot/core/log/Logger.hpp>
+#include <arpirobot/core/robot/RobotProfile.hpp>
+#include <asio.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+using namespace arpirobot;
+using asio::ip::tcp;
+using asio::ip::udp;
+typedef std::chrono::steady_clock Clock;
+
+
+struct Options{
+    std::string host = "127.0.0.1";
+    int portBase = 8090;
+    double duration = 10;
+    int controllers = 1;
+    double controllerRate = 50;
+    double ntRate = 0;
+    int ntKeys = 100;
+    double enableInterval = 1;
+    double syncInterval = 2;
+    bool ctrlExt = false;
+    bool clockSync = false;
+    bool bench = false;
+};
+
+static std::atomic<bool> running {true};
+
+// Time the last enable / disable / sync was started (ns since epoch of Clock, 0 if none pending)
+static std::atomic<int64_t> enableSentAt {0};
+static std::atomic<int64_t> disableSentAt {0};
+static std::atomic<int64_t> syncSentAt {0};
+
+static LatencyHistogram enableLatency;
+static LatencyHistogram disableLatency;
+static LatencyHistogram syncLatency;
+static std::atomic<uint64_t> controllerPacketsSent {0};
+static std::atomic<uint64_t> ntUpdatesSent {0};
+static std::atomic<uint64_t> ntBytesReceived {0};
+static std::atomic<uint64_t> logBytesReceived {0};
+
+static std::mutex ntWriteLock;
+static std::mutex commandWriteLock;
+static std::atomic<uint64_t> pingsAnswered {0};
+
+
+static int64_t nowNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static void recordIfPending(std::atomic<int64_t> &sentAt, LatencyHistogram &hist){
+    int64_t sent = sentAt.exchange(0);
+    if(sent != 0)
+        hist.record(nowNs() - sent);
+}
+
+static void usage(){
+    std::cerr << "Usage: ds-emulator [--host ADDR] [--port-base PORT] [--duration SEC] [--controllers N] [--controller-rate HZ]" << std::endl;
+    std::cerr << "                   [--nt-rate HZ] [--nt-keys N] [--enable-interval SEC] [--sync-interval SEC]" << std::endl;
+    std::cerr << "                   [--ctrl-ext] [--clock-sync] [--bench]" << std::endl;
+}
+
+static bool parseArgs(int argc, char **argv, Options &opts){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--bench"){
+            opts.bench = true;
+            continue;
+        }else if(arg == "--ctrl-ext"){
+            opts.ctrlExt = true;
+            continue;
+        }else if(arg == "--clock-sync"){
+            opts.clockSync = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+            return false;
+        std::string val = argv[++i];
+        if(arg == "--host") opts.host = val;
+        else if(arg == "--port-base") opts.portBase = std::atoi(val.c_str());
+        else if(arg == "--duration") opts.duration = std::atof(val.c_str());
+        else if(arg == "--controllers") opts.controllers = std::atoi(val.c_str());
+        else if(arg == "--controller-rate") opts.controllerRate = std::atof(val.c_str());
+        else if(arg == "--nt-rate") opts.ntRate = std::atof(val.c_str());
+        else if(arg == "--nt-keys") opts.ntKeys = std::max(1, std::atoi(val.c_str()));
+        else if(arg == "--enable-interval") opts.enableInterval = std::atof(val.c_str());
+        else if(arg == "--sync-interval") opts.syncInterval = std::atof(val.c_str());
+        else return false;
+    }
+    return true;
+}
+
+// Run func at the given rate until stopped (no catching up if behind)
+template <typename F>
+static void runAtRate(double rate, F func){
+    if(rate <= 0)
+        return;
+    auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    auto next = Clock::now();
+    while(running){
+        func();
+        next += period;
+        auto now = Clock::now();
+        if(next < now)
+            next = now;
+        else
+            std::this_thread::sleep_until(next);
+    }
+}
+
+static void controllerThread(udp::socket &socket, udp::endpoint endpoint, const Options &opts){
+    // 6 axes, 16 buttons, 1 dpad: [num,6,16,1,axes(12),buttons(2),dpad(1),\n]
+    // Extended packets have a 13 byte header [1,seq,sendTime] (big endian)
+    size_t h = opts.ctrlExt ? 13 : 0;
+    std::vector<std::vector<uint8_t>> packets(opts.controllers);
+    for(int c = 0; c < opts.controllers; ++c){
+        std::vector<uint8_t> &p = packets[c];
+        p.resize(h, 0);
+        p.insert(p.end(), {(uint8_t)c, 6, 16, 1});
+        p.resize(h + 4 + 12 + 2 + 1, 0);
+        p.push_back('\n');
+    }
+    uint32_t n = 0;
+    runAtRate(opts.controllerRate, [&](){
+        n++;
+        for(auto &p : packets){
+            if(opts.ctrlExt){
+                uint64_t sendTime = nowNs() / 1000;
+                p[0] = 1;
+                for(int i = 0; i < 4; ++i)
+                    p[1 + i] = (n >> (24 - 8 * i)) & 0xFF;
+                for(int i = 0; i < 8; ++i)
+                    p[5 + i] = (sendTime >> (56 - 8 * i)) & 0xFF;
+            }
+
+            // Move the axes so the data changes
+            for(int a = 0; a < 6; ++a){
+                int16_t v = (int16_t)((n * 97 + a * 1000) & 0x7FFF);
+                p[h + 4 + 2 * a] = (v >> 8) & 0xFF;
+                p[h + 5 + 2 * a] = v & 0xFF;
+            }
+            p[h + 16] = n & 0xFF;
+            std::error_code ec;
+            socket.send_to(asio::buffer(p), endpoint, 0, ec);
+            if(!ec)
+                controllerPacketsSent++;
+        }
+    });
+}
+
+static void ntFloodThread(tcp::socket &socket, const Options &opts){
+    uint64_t n = 0;
+    std::string line;
+    runAtRate(opts.ntRate, [&](){
+        line = "ds_load_" + std::to_string(n % opts.ntKeys) + "\377" + std::to_string(n) + "\n";
+        n++;
+        std::lock_guard<std::mutex> l(ntWriteLock);
+        std::error_code ec;
+        asio::write(socket, asio::buffer(line), ec);
+        if(!ec)
+            ntUpdatesSent++;
+    });
+}
+
+static void ntReadThread(tcp::socket &socket){
+    asio::streambuf buf;
+    std::string line;
+    while(running){
+        std::error_code ec;
+        size_t len = asio::read_until(socket, buf, '\n', ec);
+        if(ec)
+            break;
+        ntBytesReceived += len;
+        line.resize(len);
+        buf.sgetn(&line[0], len);
+        if(len >= 4 && line.compare(0, 3, "\377\377\377") == 0){
+            // Robot finished sending. Nothing to send back, so finish the sync.
+            recordIfPending(syncSentAt, syncLatency);
+            std::lock_guard<std::mutex> l(ntWriteLock);
+            asio::write(socket, asio::buffer("\377\377\377\n", 4), ec);
+        }
+    }
+}
+
+static void sendCommand(tcp::socket &socket, const std::string &command, std::error_code &ec){
+    std::lock_guard<std::mutex> l(commandWriteLock);
+    asio::write(socket, asio::buffer(command), ec);
+}
+
+static void commandReadThread(tcp::socket &socket){
+    // The robot only sends clock sync pings "PING t1". Times are this process's steady clock.
+    asio::streambuf buf;
+    std::string line;
+    while(running){
+        std::error_code ec;
+        size_t len = asio::read_until(socket, buf, '\n', ec);
+        if(ec)
+            break;
+        int64_t t2 = nowNs() / 1000;
+        line.resize(len);
+        buf.sgetn(&line[0], len);
+        if(line.compare(0, 5, "PING ") == 0){
+            std::string t1 = line.substr(5, line.size() - 6);
+            sendCommand(socket, "PONG " + t1 + " " + std::to_string(t2) + " " + std::to_string(nowNs() / 1000) + "\n", ec);
+            pingsAnswered++;
+        }
+    }
+}
+
+static void logReadThread(tcp::socket &socket){
+    asio::streambuf buf;
+    std::string line;
+    while(running){
+        std::error_code ec;
+        size_t len = asio::read_until(socket, buf, '\n', ec);
+        if(ec)
+            break;
+        logBytesReceived += len;
+        line.resize(len);
+        buf.sgetn(&line[0], len);
+        if(line.find("Robot enabled.") != std::string::npos){
+            recordIfPending(enableSentAt, enableLatency);
+        }else if(line.find("Robot disabled.") != std::string::npos){
+            recordIfPending(disableSentAt, disableLatency);
+        }
+    }
+}
+
+static void printLatency(const std::string &name, const LatencyHistogram &hist){
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(3)
+        << " n=" << std::setw(6) << hist.count()
+        << " p50=" << std::setw(9) << hist.percentile(50) / 1e6 << "ms"
+        << " p99=" << std::setw(9) << hist.percentile(99) / 1e6 << "ms"
+        << " max=" << std::setw(9) << hist.max() / 1e6 << "ms" << std::endl;
+}
+
+static void printHandler(const std::string &name, const HandlerStats &stats, double seconds){
+    uint64_t items = stats.getItems();
+    const LatencyHistogram &latency = stats.getLatency();
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+        << " calls=" << std::setw(8) << stats.getCalls()
+        << " items=" << std::setw(8) << items
+        << " items/s=" << std::setw(9) << items / seconds
+        << " cpu/item=" << std::setw(8) << (items == 0 ? 0.0 : (double)stats.getCpuNs() / items) << "ns"
+        << " p50=" << std::setw(8) << latency.percentile(50) / 1e3 << "us"
+        << " p99=" << std::setw(8) << latency.percentile(99) / 1e3 << "us"
+        << " max=" << std::setw(8) << latency.max() / 1e3 << "us" << std::endl;
+}
+
+static bool connectTcp(tcp::socket &socket, const std::string &host, unsigned short port){
+    std::error_code ec;
+    for(int attempt = 0; attempt < 50; ++attempt){
+        socket.connect(tcp::endpoint(asio::ip::make_address(host), port), ec);
+        if(!ec)
+            return true;
+        socket.close();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::cerr << "Unable to connect to " << host << ":" << port << ": " << ec.message() << std::endl;
+    return false;
+}
+
+int main(int argc, char **argv){
+    Options opts;
+    if(!parseArgs(argc, argv, opts)){
+        usage();
+        return 1;
+    }
+
+    if(opts.bench){
+        // Robot side of the connection runs in this process
+        opts.host = "127.0.0.1";
+        RobotProfile::controllerPort = opts.portBase;
+        RobotProfile::commandPort = opts.portBase + 1;
+        RobotProfile::netTablePort = opts.portBase + 2;
+        RobotProfile::logPort = opts.portBase + 3;
+        RobotProfile::maxSubscribers = 0;
+        RobotProfile::handlerStats = true;
+        NetworkManager::startNetworking([](){
+            Logger::logInfo("Robot enabled.");
+        }, [](){
+            Logger::logInfo("Robot disabled.");
+        });
+    }
+
+    asio::io_service io;
+    tcp::socket commandSocket(io);
+    tcp::socket netTableSocket(io);
+    tcp::socket logSocket(io);
+    udp::socket controllerSocket(io, udp::v4());
+    if(!connectTcp(commandSocket, opts.host, opts.portBase + 1) || 
+            !connectTcp(netTableSocket, opts.host, opts.portBase + 2) ||
+            !connectTcp(logSocket, opts.host, opts.portBase + 3)){
+        return 1;
+    }
+    udp::endpoint controllerEndpoint(asio::ip::make_address(opts.host), opts.portBase);
+
+    // Let the robot see all connections before sending data
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    if(opts.ctrlExt){
+        std::error_code ec;
+        sendCommand(commandSocket, "CTRL_EXT\n", ec);
+    }
+    if(opts.clockSync){
+        std::error_code ec;
+        sendCommand(commandSocket, "CLOCK_SYNC\n", ec);
+    }
+    if(opts.bench){
+        NetworkManager::getControllerHandlerStats().reset();
+        NetworkManager::getNetTableHandlerStats().reset();
+        NetworkManager::getCommandHandlerStats().reset();
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(ntReadThread, std::ref(netTableSocket));
+    threads.emplace_back(logReadThread, std::ref(logSocket));
+    threads.emplace_back(commandReadThread, std::ref(commandSocket));
+    threads.emplace_back(controllerThread, std::ref(controllerSocket), controllerEndpoint, std::cref(opts));
+    threads.emplace_back(ntFloodThread, std::ref(netTableSocket), std::cref(opts));
+
+    // Commands are sent from this thread
+    auto start = Clock::now();
+    auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.duration));
+    auto nextToggle = start;
+    auto nextSync = start;
+    bool enabled = false;
+    std::error_code ec;
+    while(Clock::now() < end){
+        auto now = Clock::now();
+        if(opts.enableInterval > 0 && now >= nextToggle){
+            enabled = !enabled;
+            (enabled ? enableSentAt : disableSentAt) = nowNs();
+            sendCommand(commandSocket, enabled ? "ENABLE\n" : "DISABLE\n", ec);
+            nextToggle = now + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(opts.enableInterval));
+        }
+        if(now >= nextSync && syncSentAt == 0){
+            syncSentAt = nowNs();
+            sendCommand(commandSocket, "NT_SYNC\n", ec);
+            nextSync = opts.syncInterval > 0 ? now + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(opts.syncInterval)) : end;
+        }
+        if(ec){
+            std::cerr << "Lost connection to robot: " << ec.message() << std::endl;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Give outstanding responses a moment to arrive
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    running = false;
+    commandSocket.shutdown(tcp::socket::shutdown_both, ec);
+    netTableSocket.shutdown(tcp::socket::shutdown_both, ec);
+    logSocket.shutdown(tcp::socket::shutdown_both, ec);
+    for(auto &t : threads)
+        t.join();
+
+    std::cout << std::endl << "Ran for " << std::setprecision(2) << std::fixed << seconds << "s" << std::endl;
+    std::cout << "Controller packets sent: " << controllerPacketsSent << " ("
+        << controllerPacketsSent / seconds << "/s)" << std::endl;
+    std::cout << "Net table updates sent:  " << ntUpdatesSent << " (" << ntUpdatesSent / seconds << "/s)" << std::endl;
+    std::cout << "Net table bytes received: " << ntBytesReceived << std::endl;
+    std::cout << "Log bytes received:      " << logBytesReceived << std::endl;
+    std::cout << "Clock sync pings answered: " << pingsAnswered << std::endl;
+    printLatency("Enable -> log", enableLatency);
+    printLatency("Disable -> log", disableLatency);
+    printLatency("Net table sync", syncLatency);
+
+    if(opts.bench){
+        std::cout << std::endl << "Robot receive handlers:" << std::endl;
+        printHandler("handleControllerData", NetworkManager::getControllerHandlerStats(), seconds);
+        printHandler("handleNetTableData", NetworkManager::getNetTableHandlerStats(), seconds);
+        printHandler("handleCommand", NetworkManager::getCommandHandlerStats(), seconds);
+        NetworkManager::stopNetworking();
+    }
+    return 0;
+}
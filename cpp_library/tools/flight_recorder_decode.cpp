@@ -0,0 +1,172 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ *
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts a flight recorder file (see FlightRecorder) to text or CSV. Records are printed
+ * oldest first. Incomplete records (being written when the program stopped) are skipped.
+ * Must be run on a machine with the same byte order as the robot (any x86 or ARM machine).
+ *
+ * Usage: flight-recorder-decode [--csv] file
+ *
+ * Text output: [time_s] TYPE details
+ * CSV output: seq,time_s,type,sub,data
+ * Gaps in sequence numbers (records overwritten or not completed) are reported to stderr.
+ */
+
+#include <arpirobot/core/diag/FlightRecorder.hpp>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+using namespace arpirobot;
+
+typedef FlightRecorder::RecordType RecordType;
+
+
+static const char *typeName(uint8_t type){
+    switch((RecordType)type){
+    case RecordType::Log: return "LOG";
+    case RecordType::State: return "STATE";
+    case RecordType::NetTable: return "NT";
+    case RecordType::Controller: return "CTRL";
+    case RecordType::Motor: return "MOTOR";
+    default: return "UNKNOWN";
+    }
+}
+
+static std::string hex(const uint8_t *data, size_t len){
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+    for(size_t i = 0; i < len; ++i)
+        ss << std::setw(2) << (int)data[i];
+    return ss.str();
+}
+
+static std::string details(const FlightRecord &rec){
+    const char *text = reinterpret_cast<const char*>(rec.data);
+    switch((RecordType)rec.type){
+    case RecordType::Log:
+        return std::string(text, rec.length);
+    case RecordType::State:
+        return rec.sub ? "ENABLED" : "DISABLED";
+    case RecordType::NetTable:{
+        std::string kv(text, rec.length);
+        size_t sep = kv.find((char)255);
+        std::string res = rec.sub ? "(ds) " : "(robot) ";
+        if(sep == std::string::npos)
+            return res + kv;
+        return res + kv.substr(0, sep) + "=" + kv.substr(sep + 1);
+    }
+    case RecordType::Controller:
+        return std::to_string(rec.sub) + " " + hex(rec.data, rec.length);
+    case RecordType::Motor:{
+        if(rec.length < sizeof(float))
+            return "";
+        float speed;
+        std::memcpy(&speed, rec.data, sizeof(speed));
+        std::stringstream ss;
+        ss << std::string(text + sizeof(float), rec.length - sizeof(float)) << " " << speed;
+        return ss.str();
+    }
+    default:
+        return hex(rec.data, rec.length);
+    }
+}
+
+static std::string csvQuote(const std::string &str){
+    std::string res = "\"";
+    for(char c : str){
+        if(c == '"')
+            res += '"';
+        res += c;
+    }
+    return res + "\"";
+}
+
+int main(int argc, char **argv){
+    bool csv = false;
+    std::string file;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--csv")
+            csv = true;
+        else
+            file = arg;
+    }
+    if(file.empty()){
+        std::cerr << "Usage: flight-recorder-decode [--csv] file" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(file, std::ios::binary);
+    FlightRecorderHeader header;
+    if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, "ARPIFREC", sizeof(header.magic)) != 0){
+        std::cerr << file << " is not a flight recorder file." << std::endl;
+        return 1;
+    }
+    if(header.version != FlightRecorder::VERSION || header.recordSize != sizeof(FlightRecord)){
+        std::cerr << "Unsupported flight recorder version " << header.version << "." << std::endl;
+        return 1;
+    }
+
+    std::vector<FlightRecord> records;
+    FlightRecord rec;
+    for(uint64_t slot = 0; slot < header.slotCount && in.read(reinterpret_cast<char*>(&rec), sizeof(rec)); ++slot){
+        // Skip empty and incomplete slots (and anything not where its sequence number says it should be)
+        if(rec.seq != 0 && (rec.seq - 1) % header.slotCount == slot && rec.length <= sizeof(rec.data))
+            records.push_back(rec);
+    }
+    std::sort(records.begin(), records.end(), [](const FlightRecord &a, const FlightRecord &b){
+        return a.seq < b.seq;
+    });
+
+    if(csv){
+        std::cout << "seq,time_s,type,sub,data" << std::endl;
+    }else{
+        std::time_t start = (std::time_t)(header.startTimeUs / 1000000);
+        std::cout << "Recording started " << std::put_time(std::localtime(&start), "%Y-%m-%d %H:%M:%S") <<
+            " (" << records.size() << " records)" << std::endl;
+    }
+
+    uint64_t gaps = 0;
+    for(size_t i = 0; i < records.size(); ++i){
+        const FlightRecord &r = records[i];
+        if(i > 0 && r.seq != records[i - 1].seq + 1)
+            gaps += r.seq - records[i - 1].seq - 1;
+        std::stringstream time;
+        time << std::fixed << std::setprecision(6) << (r.timeUs / 1e6);
+        if(csv){
+            std::cout << r.seq << "," << time.str() << "," << typeName(r.type) << "," << r.sub << "," <<
+                csvQuote(details(r)) << "\n";
+        }else{
+            std::cout << "[" << std::setw(14) << time.str() << "] " << std::left << std::setw(6) <<
+                typeName(r.type) << std::right << details(r) << "\n";
+        }
+    }
+    if(gaps > 0)
+        std::cerr << gaps << " records missing (incomplete when the program stopped)." << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021 Marcus Behel
+ *
+ * This file is part of ArPiRobot-CoreLib.
+ * 
+ * ArPiRobot-CoreLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * ArPiRobot-CoreLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/*
+ * Receives telemetry records (see Telemetry / NetworkManager) and prints them as CSV.
+ * Intended for testing. Run on the machine the drive station would run on (or loopback).
+ * 
+ * Usage: telemetry-receiver [port] [schema]
+ *     port    UDP port to listen on (default 8094)
+ *     schema  Value of the "telemetry_schema" net table key. If given, field names are printed.
+ * 
+ * Output: source,seq,timestamp_us,values...
+ * Lost records (gaps in sequence numbers) are reported to stderr.
+ */
+
+#include <asio.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <cstdint>
+
+struct SourceSchema{
+    std::string name;
+    std::vector<std::string> fields;
+};
+
+static std::vector<std::string> split(const std::string &str, char delim){
+    std::vector<std::string> parts;
+    std::stringstream ss(str);
+    std::string part;
+    while(std::getline(ss, part, delim))
+        parts.push_back(part);
+    return parts;
+}
+
+static std::map<int, SourceSchema> parseSchema(const std::string &schema){
+    std::map<int, SourceSchema> sources;
+    for(auto &src : split(schema, ';')){
+        auto parts = split(src, ':');
+        if(parts.size() != 3)
+            continue;
+        SourceSchema s;
+        s.name = parts[1];
+        s.fields = split(parts[2], ',');
+        sources[std::stoi(parts[0])] = s;
+    }
+    return sources;
+}
+
+static uint32_t readU32(const uint8_t *p){
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t readU64(const uint8_t *p){
+    return (uint64_t)readU32(p) | (uint64_t)readU32(p + 4) << 32;
+}
+
+int main(int argc, char **argv){
+    int port = 8094;
+    std::map<int, SourceSchema> schema;
+    if(argc > 1)
+        port = std::stoi(argv[1]);
+    if(argc > 2)
+        schema = parseSchema(argv[2]);
+
+    asio::io_service io;
+    asio::ip::udp::socket socket(io, asio::ip::udp::endpoint(asio::ip::udp::v4(), port));
+    std::cerr << "Listening for telemetry on UDP port " << port << std::endl;
+
+    if(!schema.empty()){
+        for(auto &it : schema){
+            std::cout << "# " << it.first << " " << it.second.name << ": seq,timestamp_us";
+            for(auto &f : it.second.fields)
+                std::cout << "," << f;
+            std::cout << "\n";
+        }
+    }
+
+    std::map<int, uint32_t> lastSeq;
+    std::map<int, uint64_t> lost;
+    std::vector<uint8_t> buf(65536);
+    while(true){
+        asio::ip::udp::endpoint sender;
+        size_t len = socket.receive_from(asio::buffer(buf), sender);
+        if(len < 4 || buf[0] != 'T' || buf[1] != 'L' || buf[2] != 1){
+            std::cerr << "Ignoring invalid datagram from " << sender << std::endl;
+            continue;
+        }
+        size_t count = buf[3];
+        size_t pos = 4;
+        for(size_t r = 0; r < count && pos + 13 <= len; ++r){
+            int id = buf[pos];
+            uint32_t seq = readU32(&buf[pos + 1]);
+            uint64_t timestamp = readU64(&buf[pos + 5]);
+            pos += 13;
+
+            // Without a schema, assume the rest of the datagram is this record
+            size_t fieldCount = schema.count(id) ? schema[id].fields.size() : (len - pos) / 4;
+            if(pos + fieldCount * 4 > len){
+                std::cerr << "Truncated record for source " << id << std::endl;
+                break;
+            }
+
+            if(lastSeq.count(id) && seq != lastSeq[id] + 1){
+                lost[id] += seq - lastSeq[id] - 1;
+                std::cerr << "Source " << id << ": lost " << (seq - lastSeq[id] - 1) << 
+                    " records (" << lost[id] << " total)" << std::endl;
+            }
+            lastSeq[id] = seq;
+
+            std::cout << id << "," << seq << "," << timestamp;
+            for(size_t i = 0; i < fieldCount; ++i){
+                uint32_t bits = readU32(&buf[pos]);
+                float f;
+                memcpy(&f, &bits, 4);
+                std::cout << "," << f;
+                pos += 4;
+            }
+            std::cout << "\n";
+        }
+        std::cout.flush();
+    }
+    return 0;
+}
@@ -0,0 +1,706 @@
+/*
+ * Measures how fast ArduinoUartInterface can receive and parse frames. A pseudo terminal
+ * stands in for the arduino: a writer thread sends sensor data frames (framed, escaped and
+ * CRC'd like the arduino firmware does) to the master side and the interface reads the slave
+ * side through the serial IO provider, exactly as it would read a USB / UART arduino.
+ * Pseudo terminals are not limited by a baud rate, so this measures the robot side only.
+ *
+ * Frames carry the time they were sent, so latency from write to parsed frame is reported too.
+ * Use --rate to send at a realistic rate when measuring latency.
+ *
+ * With --tx the direction is reversed: frames are sent with BaseArduinoInterface::writeData and
+ * checked on the master side, measuring how much CPU time writing frames takes.
+ *
+ * With --devices the whole interface is tested: an emulated arduino answers the setup done by
+ * BaseArduinoInterface::begin, then streams frames for the given number of devices (round robin).
+ * Frames are parsed and dispatched to the devices by the interface's processing thread.
+ * The number of bytes sent per device frame is reported to compare framing overhead.
+ * --boards runs several interfaces (each with its own emulated arduino) at once. With --async they are
+ * ArduinoAsyncUartInterfaces sharing one reactor thread instead of a processing thread per interface.
+ *
+ * Usage: uart-bench [options]
+ *     --frames N      Number of frames to send (default 100000)
+ *     --size BYTES    Payload bytes per frame, including device id and send time (default 16, min 9)
+ *     --rate HZ       Frames per second (default 0 = as fast as possible)
+ *     --legacy        Read one byte at a time polling every 5 ms (the old implementation) for comparison.
+ *                     With --tx, write one byte at a time.
+ *     --tx            Measure writing frames instead of reading them
+ *     --devices N     Run begin and the processing thread with N devices
+ *     --aggregate     With --devices, the emulated arduino accepts aggregated frames and sends the data of
+ *                     all devices in one frame per sample period. Without it the arduino behaves like
+ *                     firmware that does not support aggregated frames.
+ *     --boards N      With --devices, number of arduinos (interfaces) to run at once (default 1). Each
+ *                     sends --frames frames.
+ *     --async         With --devices, use ArduinoAsyncUartInterface instead of ArduinoUartInterface
+ *     --commands HZ   With --devices, also send a setpoint command to every device HZ times per second
+ *                     (queued and coalesced per device by the interface). Reports the interface's send counters
+ *                     and latency from queueing to writing.
+ *
+ * Linux only.
+ */
+
+#include <arpirobot/arduino/iface/ArduinoUartInterface.hpp>
+#include <arpirobot/arduino/iface/ArduinoAsyncUartInterface.hpp>
+#include <arpirobot/arduino/device/ArduinoDevice.hpp>
+#include <arpirobot/core/diag/LatencyHistogram.hpp>
+#include <arpirobot/core/util/Endian.hpp>
+#include <arpirobot/core/io/Io.hpp>
+#include <arpirobot/core/log/Logger.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace arpirobot;
+typedef std::chrono::steady_clock Clock;
+
+
+struct Options{
+    uint64_t frames = 100000;
+    size_t size = 16;
+    double rate = 0;
+    bool legacy = false;
+    bool tx = false;
+    int devices = 0;
+    bool aggregate = false;
+    int boards = 1;
+    bool async = false;
+    double commands = 0;
+};
+
+// Number of writer (or emulated arduino) threads that have finished
+static std::atomic<int> writersDone {0};
+static std::atomic<uint64_t> framesChecked {0};
+static std::atomic<uint64_t> badFrames {0};
+static std::atomic<uint64_t> bytesSent {0};
+
+// --devices statistics (updated by the threads that handle received data)
+static std::atomic<uint64_t> deviceFrames {0};
+static std::atomic<uint64_t> misdirectedFrames {0};
+static std::atomic<int64_t> processCpuNs {0};
+static std::atomic<int> processThreads {0};
+static LatencyHistogram deviceLatency;
+
+// CPU time of this thread at the end of the last frame it handled (-1 before its first frame)
+static thread_local int64_t lastFrameCpuNs = -1;
+
+
+static int64_t nowNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static int64_t threadCpuNs(){
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static double threadCpuSeconds(){
+    return threadCpuNs() / 1e9;
+}
+
+static uint16_t crc16(const uint8_t *data, size_t len){
+    uint16_t crc = 0xFFFF;
+    for(size_t i = 0; i < len; ++i){
+        crc ^= (uint16_t)data[i] << 8;
+        for(int j = 0; j < 8; ++j)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static void appendEscaped(std::vector<uint8_t> &out, uint8_t b){
+    if(b == 253 || b == 254 || b == 255)
+        out.push_back(255);
+    out.push_back(b);
+}
+
+// Encode a frame the way the arduino does: [253] escaped(payload, crc_high, crc_low) [254]
+static void encodeFrame(std::vector<uint8_t> &out, const std::vector<uint8_t> &payload){
+    out.push_back(253);
+    for(uint8_t b : payload)
+        appendEscaped(out, b);
+    uint16_t crc = crc16(payload.data(), payload.size());
+    appendEscaped(out, crc >> 8);
+    appendEscaped(out, crc & 0xFF);
+    out.push_back(254);
+}
+
+// Parses frames (same rules as BaseArduinoInterface::readData)
+struct FrameParser{
+    std::vector<uint8_t> frame;
+    bool started = false;
+    bool escaped = false;
+
+    // Returns true when b completes a frame (frame then holds the data followed by the CRC)
+    bool parse(uint8_t b){
+        if(escaped){
+            frame.push_back(b);
+            escaped = false;
+        }else if(b == 253){
+            frame.clear();
+            started = true;
+        }else if(b == 254 && started){
+            started = false;
+            return true;
+        }else if(b == 255 && started){
+            escaped = true;
+        }else{
+            frame.push_back(b);
+        }
+        return false;
+    }
+};
+
+static bool writeAll(int fd, const uint8_t *data, size_t len){
+    while(len > 0){
+        ssize_t res = ::write(fd, data, len);
+        if(res < 0){
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+        data += res;
+        len -= res;
+    }
+    return true;
+}
+
+static void writerThread(int fd, const Options &opts){
+    std::vector<uint8_t> payload(opts.size, 0);
+    payload[0] = 1; // Device id (cycles through devices with --devices)
+    for(size_t i = 9; i < payload.size(); ++i)
+        payload[i] = (uint8_t)i;
+
+    // Batch frames into larger writes when sending as fast as possible
+    size_t batch = opts.rate > 0 ? 1 : 64;
+    auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts.rate > 0 ? 1.0 / opts.rate : 0));
+    auto next = Clock::now();
+    std::vector<uint8_t> buf;
+    std::vector<uint8_t> aggregate;
+    for(uint64_t sent = 0; sent < opts.frames;){
+        buf.clear();
+        for(size_t i = 0; i < batch && sent < opts.frames; ++i){
+            int64_t t = nowNs();
+            std::memcpy(&payload[1], &t, sizeof(t));
+            if(opts.aggregate && opts.devices > 0){
+                // One frame with data for every device: 255, count, then (length, id, data...) per device
+                aggregate.assign({255, 0});
+                for(int dev = 0; dev < opts.devices && sent < opts.frames; ++dev, ++sent){
+                    payload[0] = dev;
+                    aggregate.push_back(payload.size() - 1);
+                    aggregate.insert(aggregate.end(), payload.begin(), payload.end());
+                    aggregate[1]++;
+                }
+                encodeFrame(buf, aggregate);
+            }else{
+                if(opts.devices > 0)
+                    payload[0] = sent % opts.devices;
+                encodeFrame(buf, payload);
+                ++sent;
+            }
+        }
+        bytesSent += buf.size();
+        if(!writeAll(fd, buf.data(), buf.size())){
+            std::cerr << "Write to pseudo terminal failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if(opts.rate > 0){
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+    writersDone++;
+}
+
+// Parse frames written by the interface and check their CRC (until fd is closed)
+static void checkerThread(int fd){
+    uint8_t buf[4096];
+    FrameParser parser;
+    const std::vector<uint8_t> &frame = parser.frame;
+    while(true){
+        ssize_t res = ::read(fd, buf, sizeof(buf));
+        if(res <= 0){
+            if(res < 0 && errno == EINTR)
+                continue;
+            return;
+        }
+        for(ssize_t i = 0; i < res; ++i){
+            if(!parser.parse(buf[i]))
+                continue;
+            if(frame.size() < 2 || crc16(frame.data(), frame.size() - 2) !=
+                    (frame[frame.size() - 2] << 8 | frame[frame.size() - 1]))
+                badFrames++;
+            framesChecked++;
+        }
+    }
+}
+
+static bool sendFrame(int fd, const std::vector<uint8_t> &payload){
+    std::vector<uint8_t> buf;
+    encodeFrame(buf, payload);
+    return writeAll(fd, buf.data(), buf.size());
+}
+
+// Emulated arduino for --devices. Answers the commands sent by begin (like the firmware), then streams frames.
+static void arduinoThread(int fd, const Options &opts){
+    const std::vector<uint8_t> start = {'S', 'T', 'A', 'R', 'T'};
+    sendFrame(fd, start);
+
+    uint8_t buf[256];
+    FrameParser parser;
+    uint8_t nextId = 0;
+    bool configured = false;
+    while(!configured){
+        ssize_t res = ::read(fd, buf, sizeof(buf));
+        if(res <= 0){
+            if(res < 0 && errno == EINTR)
+                continue;
+            writersDone++;
+            return;
+        }
+        for(ssize_t i = 0; i < res; ++i){
+            if(!parser.parse(buf[i]) || parser.frame.size() < 2)
+                continue;
+            std::string cmd(parser.frame.begin(), parser.frame.end() - 2);
+            if(cmd.compare(0, 3, "ADD") == 0){
+                std::vector<uint8_t> reply = {'A', 'D', 'D', 'S', 'U', 'C', 'C', 'E', 'S', 'S', nextId++};
+                sendFrame(fd, reply);
+            }else if(cmd == "AGG"){
+                if(opts.aggregate)
+                    sendFrame(fd, {'A', 'G', 'G'});
+            }else if(cmd == "RESET"){
+                sendFrame(fd, start);
+            }else if(cmd == "END"){
+                sendFrame(fd, {'E', 'N', 'D'});
+                configured = true;
+            }
+        }
+    }
+    writerThread(fd, opts);
+}
+
+// Device for --devices. Records latency of each frame it is given.
+class BenchDevice : public ArduinoDevice{
+public:
+    BenchDevice(int index) : ArduinoDevice(true, -1){
+        deviceName = "BenchDevice(" + std::to_string(index) + ")";
+    }
+
+protected:
+    void applyDefaultState() override{
+
+    }
+
+public:
+    // 'S' (setpoint command), value (int32 little endian)
+    bool setpoint(int32_t value){
+        std::vector<uint8_t> msg = {'S'};
+        Endian::append(msg, value, ByteOrder::Little);
+        return sendData(msg);
+    }
+
+protected:
+
+    std::vector<uint8_t> getCreateData() override{
+        return stringToData("ADDBENCH");
+    }
+
+    void handleData(ByteView data) override{
+        // CPU time is counted from the start of the first frame each thread handles to the end of its last frame
+        if(lastFrameCpuNs < 0){
+            lastFrameCpuNs = threadCpuNs();
+            processThreads++;
+        }
+        if(data.size() >= 9){
+            int64_t sentAt;
+            std::memcpy(&sentAt, &data[1], sizeof(sentAt));
+            deviceLatency.record(nowNs() - sentAt);
+        }
+        if(data[0] != deviceId)
+            misdirectedFrames++;
+        deviceFrames++;
+        int64_t cpu = threadCpuNs();
+        processCpuNs += cpu - lastFrameCpuNs;
+        lastFrameCpuNs = cpu;
+    }
+};
+
+/*
+ * Exposes the protected parsing functions. In legacy mode reads are done the way
+ * ArduinoUartInterface used to: wait for data in 5 ms sleeps, then read one byte.
+ * Writes are done one byte at a time.
+ */
+class BenchInterface : public ArduinoUartInterface{
+public:
+    BenchInterface(std::string port, bool legacy) : ArduinoUartInterface(port, 115200), legacy(legacy){
+
+    }
+
+    ~BenchInterface(){
+        // The processing thread uses readChunk
+        stopProcessing();
+    }
+
+    void openPort(){
+        open();
+    }
+
+    void send(const std::vector<uint8_t> &data){
+        writeData(data);
+    }
+
+    bool nextFrame(int timeoutMs){
+        return readData(timeoutMs) && checkData();
+    }
+
+    const std::vector<uint8_t> &frame(){
+        return readDataset;
+    }
+
+protected:
+    size_t readChunk(uint8_t *buf, size_t count, int timeoutMs) override{
+        if(!legacy)
+            return ArduinoUartInterface::readChunk(buf, count, timeoutMs);
+        auto start = Clock::now();
+        while(available() == 0){
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            if(Clock::now() - start >= std::chrono::milliseconds(timeoutMs))
+                return 0;
+        }
+        return ArduinoUartInterface::readChunk(buf, 1, 0);
+    }
+
+    void write(const uint8_t *data, size_t len) override{
+        if(!legacy){
+            ArduinoUartInterface::write(data, len);
+            return;
+        }
+        for(size_t i = 0; i < len; ++i)
+            ArduinoUartInterface::write(data + i, 1);
+    }
+
+private:
+    bool legacy;
+};
+
+static void usage(){
+    std::cerr << "Usage: uart-bench [--frames N] [--size BYTES] [--rate HZ] [--legacy] [--tx] [--devices N] [--aggregate] " <<
+        "[--boards N] [--async] [--commands HZ]" << std::endl;
+}
+
+static bool parseArgs(int argc, char **argv, Options &opts){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--legacy"){
+            opts.legacy = true;
+            continue;
+        }else if(arg == "--tx"){
+            opts.tx = true;
+            continue;
+        }else if(arg == "--aggregate"){
+            opts.aggregate = true;
+            continue;
+        }else if(arg == "--async"){
+            opts.async = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+            return false;
+        std::string val = argv[++i];
+        if(arg == "--frames") opts.frames = std::strtoull(val.c_str(), nullptr, 10);
+        else if(arg == "--size") opts.size = std::max(9, std::min(256, std::atoi(val.c_str())));
+        else if(arg == "--rate") opts.rate = std::atof(val.c_str());
+        else if(arg == "--devices") opts.devices = std::max(0, std::min(250, std::atoi(val.c_str())));
+        else if(arg == "--commands") opts.commands = std::atof(val.c_str());
+        else if(arg == "--boards") opts.boards = std::max(1, std::min(64, std::atoi(val.c_str())));
+        else return false;
+    }
+    return true;
+}
+
+// The interface opens the slave side. The bench uses the master side as the arduino.
+static bool openPseudoTerminal(int &master, int &slave, std::string &slaveName){
+    char name[256];
+    if(openpty(&master, &slave, name, nullptr, nullptr) != 0){
+        std::cerr << "Unable to open a pseudo terminal: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // Raw mode so no bytes are translated or buffered into lines
+    termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    slaveName = name;
+    return true;
+}
+
+static int benchTx(BenchInterface &iface, int master, const Options &opts){
+    std::thread checker(checkerThread, master);
+
+    std::vector<uint8_t> payload(opts.size, 0);
+    payload[0] = 1;
+    for(size_t i = 1; i < payload.size(); ++i)
+        payload[i] = (uint8_t)(i * 37);
+
+    auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts.rate > 0 ? 1.0 / opts.rate : 0));
+    auto start = Clock::now();
+    auto next = start;
+    double cpu = 0;
+    for(uint64_t i = 0; i < opts.frames; ++i){
+        double cpuStart = threadCpuSeconds();
+        iface.send(payload);
+        cpu += threadCpuSeconds() - cpuStart;
+        if(opts.rate > 0){
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Wait for the checker to catch up
+    auto deadline = Clock::now() + std::chrono::seconds(2);
+    while(framesChecked < opts.frames && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    shutdown(master, SHUT_RDWR);
+    close(master);
+    checker.detach();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << (opts.legacy ? "legacy (byte at a time)" : "single write") << " writer, " << opts.size << " byte payloads" << std::endl;
+    std::cout << "frames      " << framesChecked << " / " << opts.frames << " (" << badFrames << " bad) in " <<
+        std::setprecision(3) << seconds << "s" << std::endl;
+    std::cout << std::setprecision(1);
+    std::cout << "frames/s    " << opts.frames / seconds << std::endl;
+    std::cout << "writer cpu  " << cpu * 1e9 / opts.frames << " ns/frame" << std::endl;
+    return (framesChecked == opts.frames && badFrames == 0) ? 0 : 1;
+}
+
+static int benchDevices(const Options &opts){
+    std::vector<int> masters;
+    std::vector<int> slaves;
+    std::vector<std::unique_ptr<BaseArduinoInterface>> ifaces;
+    std::vector<std::shared_ptr<BenchDevice>> devices;
+    for(int board = 0; board < opts.boards; ++board){
+        int master, slave;
+        std::string slaveName;
+        if(!openPseudoTerminal(master, slave, slaveName))
+            return 1;
+        masters.push_back(master);
+        slaves.push_back(slave);
+        if(opts.async)
+            ifaces.emplace_back(new ArduinoAsyncUartInterface(slaveName, 115200));
+        else
+            ifaces.emplace_back(new BenchInterface(slaveName, opts.legacy));
+        for(int i = 0; i < opts.devices; ++i){
+            devices.push_back(std::make_shared<BenchDevice>(i));
+            ifaces.back()->addDevice(devices.back());
+        }
+    }
+
+    std::vector<std::thread> arduinos;
+    for(int master : masters)
+        arduinos.emplace_back(arduinoThread, master, std::cref(opts));
+    for(auto &iface : ifaces){
+        if(!iface->begin()){
+            std::cerr << "Setup with the emulated arduino failed." << std::endl;
+            for(size_t i = 0; i < masters.size(); ++i){
+                shutdown(masters[i], SHUT_RDWR);
+                arduinos[i].detach();
+            }
+            return 1;
+        }
+    }
+
+    // Check commands sent by the interfaces (the emulated arduinos no longer read once configured)
+    std::vector<std::thread> checkers;
+    if(opts.commands > 0){
+        for(int master : masters)
+            checkers.emplace_back(checkerThread, master);
+    }
+
+    // Setpoints are sent from another thread while frames are received
+    std::atomic<bool> receiving {true};
+    std::atomic<uint64_t> commandsQueued {0};
+    std::thread commander([&](){
+        if(opts.commands <= 0)
+            return;
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / opts.commands));
+        auto next = Clock::now();
+        for(int32_t value = 0; receiving; ++value){
+            for(auto &dev : devices){
+                if(dev->setpoint(value))
+                    commandsQueued++;
+            }
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    uint64_t expected = opts.frames * opts.boards;
+    auto start = Clock::now();
+    auto lastProgress = start;
+    uint64_t lastCount = 0;
+    while(deviceFrames < expected){
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        uint64_t count = deviceFrames;
+        if(count != lastCount){
+            lastCount = count;
+            lastProgress = Clock::now();
+        }else if(writersDone == opts.boards && Clock::now() - lastProgress > std::chrono::seconds(1)){
+            break;
+        }
+    }
+    double seconds = std::chrono::duration<double>(lastProgress - start).count();
+    receiving = false;
+    commander.join();
+    for(auto &arduino : arduinos)
+        arduino.join();
+    uint64_t received = deviceFrames;
+    double cpuNs = processCpuNs;
+    bool negotiated = true;
+    for(auto &iface : ifaces)
+        negotiated = negotiated && iface->isAggregating() == opts.aggregate;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << opts.boards << (opts.async ? " async" : "") << " interface(s) with " << opts.devices << " devices, " << 
+        opts.size << " byte payloads, " << (opts.aggregate ? "aggregated frames" : "frame per device") << std::endl;
+    std::cout << "frames      " << received << " / " << expected << " (" << misdirectedFrames << " misdirected) in " <<
+        std::setprecision(3) << seconds << "s" << std::endl;
+    std::cout << std::setprecision(1);
+    std::cout << "frames/s    " << received / seconds << std::endl;
+    std::cout << "wire bytes  " << (double)bytesSent / expected << " per device frame" << std::endl;
+    std::cout << "threads     " << processThreads << " handling received data" << std::endl;
+    std::cout << "process cpu " << cpuNs / 1e7 / seconds << "% (" << (received == 0 ? 0.0 : cpuNs / received) << " ns/frame)" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "latency     p50=" << deviceLatency.percentile(50) / 1e6 << "ms p99=" << deviceLatency.percentile(99) / 1e6 <<
+        "ms max=" << deviceLatency.max() / 1e6 << "ms" << std::endl;
+
+    bool commandsOk = true;
+    if(opts.commands > 0){
+        ArduinoSendStats total;
+        uint64_t p50 = 0, p99 = 0, max = 0;
+        for(auto &iface : ifaces){
+            ArduinoSendStats stats = iface->getSendStats();
+            total.queuedCommands += stats.queuedCommands;
+            total.peakQueuedCommands = std::max(total.peakQueuedCommands, stats.peakQueuedCommands);
+            total.sentCommands += stats.sentCommands;
+            total.coalescedCommands += stats.coalescedCommands;
+            total.droppedCommands += stats.droppedCommands;
+            const LatencyHistogram &latency = iface->getSendLatency();
+            p50 = std::max(p50, latency.percentile(50));
+            p99 = std::max(p99, latency.percentile(99));
+            max = std::max(max, latency.max());
+        }
+
+        // Wait for the emulated arduinos to receive what was sent
+        auto deadline = Clock::now() + std::chrono::seconds(2);
+        while(framesChecked < total.sentCommands && Clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        std::cout << "commands    " << commandsQueued << " queued, " << total.sentCommands << " sent (" << framesChecked << 
+            " received, " << badFrames << " bad), " << total.coalescedCommands << " coalesced, " << total.droppedCommands << 
+            " dropped, peak queue " << total.peakQueuedCommands << std::endl;
+        std::cout << "send lat    p50=" << p50 / 1e6 << "ms p99=" << p99 / 1e6 << "ms max=" << max / 1e6 << 
+            "ms (worst interface)" << std::endl;
+        commandsOk = framesChecked == total.sentCommands && badFrames == 0 && 
+            total.sentCommands + total.coalescedCommands + total.queuedCommands == commandsQueued;
+    }
+
+    // Checkers stop once the slave side is closed
+    ifaces.clear();
+    for(int slave : slaves)
+        close(slave);
+    for(auto &checker : checkers)
+        checker.join();
+    for(int master : masters)
+        close(master);
+    return (received == expected && misdirectedFrames == 0 && negotiated && commandsOk) ? 0 : 1;
+}
+
+int main(int argc, char **argv){
+    Options opts;
+    if(!parseArgs(argc, argv, opts)){
+        usage();
+        return 1;
+    }
+
+    Logger::setLevel(Logger::Level::Warning);
+    Io::init(Io::PROVIDER_SERIAL);
+    if(opts.devices > 0)
+        return benchDevices(opts);
+
+    int master, slave;
+    std::string slaveName;
+    if(!openPseudoTerminal(master, slave, slaveName))
+        return 1;
+    BenchInterface iface(slaveName, opts.legacy);
+    try{
+        iface.openPort();
+    }catch(const std::exception &e){
+        std::cerr << "Unable to open " << slaveName << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    if(opts.tx){
+        int res = benchTx(iface, master, opts);
+        close(slave);
+        return res;
+    }
+
+    std::thread writer(writerThread, master, std::cref(opts));
+
+    LatencyHistogram latency;
+    uint64_t received = 0;
+    uint64_t bytes = 0;
+    auto lastFrame = Clock::now();
+    auto start = Clock::now();
+    double cpuStart = threadCpuSeconds();
+    while(received < opts.frames){
+        if(iface.nextFrame(100)){
+            const std::vector<uint8_t> &frame = iface.frame();
+            if(frame.size() >= 9){
+                int64_t sentAt;
+                std::memcpy(&sentAt, &frame[1], sizeof(sentAt));
+                latency.record(nowNs() - sentAt);
+            }
+            received++;
+            bytes += frame.size();
+            lastFrame = Clock::now();
+        }else if(writersDone > 0 && Clock::now() - lastFrame > std::chrono::seconds(1)){
+            break;
+        }
+    }
+    double seconds = std::chrono::duration<double>(lastFrame - start).count();
+    double cpu = threadCpuSeconds() - cpuStart;
+    writer.join();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << (opts.legacy ? "legacy (byte at a time)" : "chunked") << " reader, " << opts.size << " byte payloads" << std::endl;
+    std::cout << "frames      " << received << " / " << opts.frames << " in " << std::setprecision(3) << seconds << "s" << std::endl;
+    std::cout << std::setprecision(1);
+    std::cout << "frames/s    " << received / seconds << std::endl;
+    std::cout << "payload     " << bytes / seconds / 1e6 << " MB/s" << std::endl;
+    std::cout << "reader cpu  " << cpu * 100 / seconds << "% (" << (received == 0 ? 0.0 : cpu * 1e9 / received) << " ns/frame)" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "latency     p50=" << latency.percentile(50) / 1e6 << "ms p99=" << latency.percentile(99) / 1e6 <<
+        "ms max=" << latency.max() / 1e6 << "ms" << std::endl;
+
+    close(master);
+    close(slave);
+    return received == opts.frames ? 0 : 1;
+}
@@ -102,6 +102,36 @@ arpirobot.RobotProfile_setIoProvider.restype = None
 arpirobot.RobotProfile_getIoProvider.argtypes = []
 arpirobot.RobotProfile_getIoProvider.restype = ctypes.c_void_p
 
+arpirobot.RobotProfile_setNetworkBindAddress.argtypes = [ctypes.c_char_p]
+arpirobot.RobotProfile_setNetworkBindAddress.restype = None
+
+arpirobot.RobotProfile_getNetworkBindAddress.argtypes = []
+arpirobot.RobotProfile_getNetworkBindAddress.restype = ctypes.c_void_p
+
+arpirobot.RobotProfile_setControllerPort.argtypes = [ctypes.c_int]
+arpirobot.RobotProfile_setControllerPort.restype = None
+
+arpirobot.RobotProfile_getControllerPort.argtypes = []
+arpirobot.RobotProfile_getControllerPort.restype = ctypes.c_int
+
+arpirobot.RobotProfile_setCommandPort.argtypes = [ctypes.c_int]
+arpirobot.RobotProfile_setCommandPort.restype = None
+
+arpirobot.RobotProfile_getCommandPort.argtypes = []
+arpirobot.RobotProfile_getCommandPort.restype = ctypes.c_int
+
+arpirobot.RobotProfile_setNetTablePort.argtypes = [ctypes.c_int]
+arpirobot.RobotProfile_setNetTablePort.restype = None
+
+arpirobot.RobotProfile_getNetTablePort.argtypes = []
+arpirobot.RobotProfile_getNetTablePort.restype = ctypes.c_int
+
+arpirobot.RobotProfile_setLogPort.argtypes = [ctypes.c_int]
+arpirobot.RobotProfile_setLogPort.restype = None
+
+arpirobot.RobotProfile_getLogPort.argtypes = []
+arpirobot.RobotProfile_getLogPort.restype = ctypes.c_int
+
 ################################################################################
 # MainVMon Bridge
 ################################################################################
@@ -156,6 +186,18 @@ arpirobot.Logger_logErrorFrom.restype = None
 arpirobot.Logger_logNewline.argtypes = []
 arpirobot.Logger_logNewline.restype = None
 
+arpirobot.Logger_setLevel.argtypes = [ctypes.c_int]
+arpirobot.Logger_setLevel.restype = None
+
+arpirobot.Logger_getLevel.argtypes = []
+arpirobot.Logger_getLevel.restype = ctypes.c_int
+
+arpirobot.Logger_setSourceLevel.argtypes = [ctypes.c_char_p, ctypes.c_int]
+arpirobot.Logger_setSourceLevel.restype = None
+
+arpirobot.Logger_clearSourceLevel.argtypes = [ctypes.c_char_p]
+arpirobot.Logger_clearSourceLevel.restype = None
+
 
 ################################################################################
 # BaseDevice Bridge
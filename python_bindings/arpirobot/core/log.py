@@ -19,12 +19,21 @@ along with ArPiRobot-CoreLib.  If not, see <https://www.gnu.org/licenses/>.
 
 import arpirobot.bridge as bridge
 import ctypes
+from enum import IntEnum
 
 
 ## Helper class with static methods for logging messages.
 #  Log messages will be printed to stdout and sent to a connected DS.
 class Logger:
 
+    ## Message severity. Messages below the enabled level are not logged.
+    class Level(IntEnum):
+        Debug = 0
+        Info = 1
+        Warning = 2
+        Error = 3
+        Off = 4
+
     ## Log a debug message
     #  @param message The message to log
     @staticmethod
@@ -80,4 +89,29 @@ class Logger:
     ## Add an empty line to the log
     @staticmethod
     def log_newline():
-        bridge.arpirobot.Logger_logNewline()
\ No newline at end of file
+        bridge.arpirobot.Logger_logNewline()
+
+    ## Set the lowest level logged (default Debug). Applies to messages without a source and 
+    #  sources without their own level.
+    #  @param level The level
+    @staticmethod
+    def set_level(level: 'Logger.Level'):
+        bridge.arpirobot.Logger_setLevel(int(level))
+
+    ## Get the lowest level logged for sources without their own level
+    @staticmethod
+    def get_level() -> 'Logger.Level':
+        return Logger.Level(bridge.arpirobot.Logger_getLevel())
+
+    ## Set the lowest level logged for messages from a specific source
+    #  @param source The source (often a device name)
+    #  @param level The level
+    @staticmethod
+    def set_source_level(source: str, level: 'Logger.Level'):
+        bridge.arpirobot.Logger_setSourceLevel(ctypes.c_char_p(source.encode()), int(level))
+
+    ## Use the global level for messages from a source again
+    #  @param source The source (often a device name)
+    @staticmethod
+    def clear_source_level(source: str):
+        bridge.arpirobot.Logger_clearSourceLevel(ctypes.c_char_p(source.encode()))
@@ -76,6 +76,49 @@ class RobotProfileSingleton:
     def io_provider(self, value: str):
         bridge.arpirobot.RobotProfile_setIoProvider(ctypes.c_char_p(value.encode()))
 
+    @property
+    def network_bind_address(self) -> str:
+        res = ctypes.c_char_p(bridge.arpirobot.RobotProfile_getNetworkBindAddress())
+        retval = res.value.decode()
+        bridge.arpirobot.freeString(res)
+        return retval
+    
+    @network_bind_address.setter
+    def network_bind_address(self, value: str):
+        bridge.arpirobot.RobotProfile_setNetworkBindAddress(ctypes.c_char_p(value.encode()))
+    
+    @property
+    def controller_port(self):
+        return bridge.arpirobot.RobotProfile_getControllerPort()
+    
+    @controller_port.setter
+    def controller_port(self, value: int):
+        bridge.arpirobot.RobotProfile_setControllerPort(value)
+    
+    @property
+    def command_port(self):
+        return bridge.arpirobot.RobotProfile_getCommandPort()
+    
+    @command_port.setter
+    def command_port(self, value: int):
+        bridge.arpirobot.RobotProfile_setCommandPort(value)
+    
+    @property
+    def net_table_port(self):
+        return bridge.arpirobot.RobotProfile_getNetTablePort()
+    
+    @net_table_port.setter
+    def net_table_port(self, value: int):
+        bridge.arpirobot.RobotProfile_setNetTablePort(value)
+    
+    @property
+    def log_port(self):
+        return bridge.arpirobot.RobotProfile_getLogPort()
+    
+    @log_port.setter
+    def log_port(self, value: int):
+        bridge.arpirobot.RobotProfile_setLogPort(value)
+
 
 RobotProfile = RobotProfileSingleton()
 